@@ -5,6 +5,7 @@
 #include "bmp280.h"
 #include "i2c.h"
 #include "aggregator.h"
+#include "sensor_registry.h"
 
 // Calibration parameters
 uint16_t dig_T1;
@@ -13,13 +14,13 @@ uint16_t dig_P1;
 int16_t dig_P2, dig_P3, dig_P4, dig_P5, dig_P6, dig_P7, dig_P8, dig_P9;
 int32_t t_fine;
 
-void bmp280_init(const struct device *i2c_dev) {
+int bmp280_init(const struct device *i2c_dev) {
     uint8_t chip_id;
 
     // Read Chip ID
     if (i2c_read_register(i2c_dev, BMP280_ADDR, BMP280_REG_CHIPID, &chip_id) != 0 || chip_id != 0x58) {
         printk("BMP280 not detected or invalid Chip ID\n");
-        return;
+        return -ENODEV;
     }
     printk("BMP280 detected. Chip ID: 0x%x\n", chip_id);
 
@@ -31,7 +32,7 @@ void bmp280_init(const struct device *i2c_dev) {
     uint8_t calib_data[24];
     if (i2c_read_registers(i2c_dev, BMP280_ADDR, BMP280_REG_CALIB_START, calib_data, sizeof(calib_data)) != 0) {
         printk("Error: Failed to read calibration data\n");
-        return;
+        return -EIO;
     }
 
     // Parse calibration data
@@ -52,6 +53,7 @@ void bmp280_init(const struct device *i2c_dev) {
     uint8_t ctrl_meas = (0x01 << 5) | (0x01 << 2) | 0x03;
     i2c_write_register(i2c_dev, BMP280_ADDR, BMP280_REG_CONTROL, ctrl_meas);
     i2c_write_register(i2c_dev, BMP280_ADDR, BMP280_REG_CONFIG, 0);
+    return 0;
 }
 
 void read_bmp280_data(const struct device *i2c_dev) {
@@ -59,7 +61,6 @@ void read_bmp280_data(const struct device *i2c_dev) {
 
     if (i2c_read_registers(i2c_dev, BMP280_ADDR, BMP280_REG_PRESSURE_MSB, data, sizeof(data)) != 0) {
         printk("Failed to read BMP280 data\n");
-        aggregator_add_float(0.0f);
         return;
     }
 
@@ -90,6 +91,22 @@ void read_bmp280_data(const struct device *i2c_dev) {
 
     float pressure = (float)p / 25600;  // Convert to hPa
 
-    aggregator_add_float((double)pressure);
+    aggregator_add_float(TELEMETRY_PRESSURE, (double)pressure);
+
+}
+
+static int bmp280_sensor_init(void)
+{
+    if (!device_is_ready(i2c_dev0)) {
+        return -ENODEV;
+    }
+    return bmp280_init(i2c_dev0);
+}
+
+static void bmp280_sensor_read(void)
+{
+    read_bmp280_data(i2c_dev0);
+}
 
-}
\ No newline at end of file
+SENSOR_DEFINE(bmp280, "BMP280", I2C_BUS0, bmp280_sensor_init, bmp280_sensor_read,
+              CONFIG_BMP280_PERIOD_MS, SENSOR_FIELD(PRESSURE));
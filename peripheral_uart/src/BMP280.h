@@ -26,7 +26,7 @@
 #define BMP280_REG_PRESSURE_MSB   0xF7
 #define BMP280_REG_TEMPERATURE_MSB 0xFA
 
-void bmp280_init(const struct device *i2c_dev);
+int bmp280_init(const struct device *i2c_dev);
 void read_bmp280_data(const struct device *i2c_dev);
 
 #endif
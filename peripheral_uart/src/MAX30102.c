@@ -1,10 +1,14 @@
 #include "MAX30102.h"
 #include "i2c.h"
 #include "heart_rate.h"
-#include "spo2_algorithm.h"
-#include "aggregator.h"
+#include "spo2_stream.h"
+#include "waveform.h"
+#include "ppg_dsp.h"
+#include "sensor_registry.h"
+#include "timestamp.h"
 #include <stdlib.h>
 
+static const uint8_t MAX30102_INT_ENABLE_1       = 0x02;
 static const uint8_t MAX30102_FIFO_CONFIG        = 0x08;
 static const uint8_t MAX30102_MODE_CONFIG        = 0x09;
 static const uint8_t MAX30102_SPO2_CONFIG        = 0x0A;
@@ -14,12 +18,61 @@ static const uint8_t MAX30102_LED2_PA            = 0x0D;
 static const uint8_t MAX30102_FIFO_WR_PTR        = 0x04;
 static const uint8_t MAX30102_FIFO_O_CNTR        = 0x05;
 static const uint8_t MAX30102_FIFO_RD_PTR        = 0x06;
+static const uint8_t MAX30102_FIFO_DATA          = 0x07;
 
-static sensor_struct sensor_data;
+#define MAX30102_FIFO_DEPTH 32
+#define MAX30102_BYTES_PER_SAMPLE 6 // 3 bytes red + 3 bytes ir
+#define MAX30102_FIFO_A_FULL 15     // free FIFO slots left when the almost full interrupt fires
+
+/*
+ * A missed edge is recovered by draining anyway once the interrupt is half of
+ * the remaining FIFO headroom overdue: 24 sample periods, 960 ms at 25 sps,
+ * against 17 until the interrupt and 32 until the FIFO overflows.
+ */
+#define MAX30102_INT_TIMEOUT_MS \
+	((MAX30102_FIFO_DEPTH - MAX30102_FIFO_A_FULL + MAX30102_FIFO_A_FULL / 2) * 1000 / FreqS)
+
+#if defined(CONFIG_MAX30102_INTERRUPT) && defined(MAX30102_INT_DT_SPEC)
+#define MAX30102_USE_INTERRUPT 1
+static const uint8_t MAX30102_INT_STATUS_1       = 0x00;
+
+// timestamp_now() of the last almost full interrupt, consumed by the next drain
+static uint64_t max30102_int_time;
+static bool max30102_int_time_valid;
+static struct k_spinlock max30102_int_lock;
+
+static uint32_t max30102_int_drains;     // drains woken by the almost full interrupt
+static uint32_t max30102_timeout_drains; // drains after MAX30102_INT_TIMEOUT_MS without one
+#endif
+
+static uint32_t max30102_overflow_count; // samples lost in the sensor FIFO
+static uint64_t max30102_drain_time;     // timestamp_now() of the last FIFO pointer read
+
+// on-chip averaging decimates the ADC rate down to the SpO2 algorithm rate
+#define MAX30102_SAMPLE_AVG (CONFIG_MAX30102_SAMPLE_RATE / FreqS)
+BUILD_ASSERT(CONFIG_MAX30102_SAMPLE_RATE % FreqS == 0 && IS_POWER_OF_TWO(MAX30102_SAMPLE_AVG) &&
+	     MAX30102_SAMPLE_AVG <= 32, "MAX30102 sample rate must be SpO2 rate * 1, 2, 4, ..., 32");
+
+/*
+ * @brief Discard every sample in the FIFO
+ */
+static void max30102_clear_fifo(const struct i2c_dt_spec *dev_max30102)
+{
+	d_i2c_write_to_reg(dev_max30102, MAX30102_FIFO_WR_PTR, 0x00);
+	d_i2c_write_to_reg(dev_max30102, MAX30102_FIFO_O_CNTR, 0x00);
+	d_i2c_write_to_reg(dev_max30102, MAX30102_FIFO_RD_PTR, 0x00);
+	max30102_drain_time = timestamp_now();
+#ifdef MAX30102_USE_INTERRUPT
+	k_spinlock_key_t key = k_spin_lock(&max30102_int_lock);
+
+	max30102_int_time_valid = false;
+	k_spin_unlock(&max30102_int_lock, key);
+#endif
+}
 
 void max30102_default_setup(const struct i2c_dt_spec *dev_max30102)
 {
-    max30102_pulse_oximeter_setup(dev_max30102, 1, false, 15, SPO2, 100, 441, 4096);
+    max30102_pulse_oximeter_setup(dev_max30102, MAX30102_SAMPLE_AVG, false, MAX30102_FIFO_A_FULL, SPO2, CONFIG_MAX30102_SAMPLE_RATE, 411, 4096);
 }
 
 /*
@@ -175,45 +228,146 @@ void max30102_pulse_oximeter_setup(const struct i2c_dt_spec *dev_max30102, uint8
 	data = 0x1F;
 	d_i2c_write_to_reg(dev_max30102, address, data);
 
-	// clear fifo
-	d_i2c_write_to_reg(dev_max30102, MAX30102_FIFO_WR_PTR, 0x00);
-	d_i2c_write_to_reg(dev_max30102, MAX30102_FIFO_O_CNTR, 0x00);
-	d_i2c_write_to_reg(dev_max30102, MAX30102_FIFO_RD_PTR, 0x00);
+	max30102_clear_fifo(dev_max30102);
+
+#ifdef MAX30102_USE_INTERRUPT
+	// enable FIFO almost full interrupt (A_FULL_EN) // 1_x_x_xxxx_x
+	d_i2c_write_to_reg(dev_max30102, MAX30102_INT_ENABLE_1, 0x80);
+	max30102_start_acquisition(dev_max30102);
+#else
+	d_i2c_write_to_reg(dev_max30102, MAX30102_INT_ENABLE_1, 0x00);
+#endif
 }
 
 /*
- * @brief Get the data from the pulse oximeter
- * @return The number of samples read
- * TODO: need to implement this better - it currently only reads one sample
+ * @brief Time at which the newest of @p available FIFO samples was taken
+ * @details With the almost full interrupt the FIFO held exactly
+ *          MAX30102_FIFO_DEPTH - MAX30102_FIFO_A_FULL samples when it fired,
+ *          as every drain empties it; later samples follow at the
+ *          measured PPG rate. Otherwise, and when polling, the newest sample is
+ *          taken to be the one written just before the pointers were read.
  */
-int max30102_check(const struct i2c_dt_spec *dev_max30102)
+static uint64_t max30102_newest_time(int available, bool overflow, uint64_t read_time)
 {
-	bool ret;
+#ifdef MAX30102_USE_INTERRUPT
+	const int trigger_samples = MAX30102_FIFO_DEPTH - MAX30102_FIFO_A_FULL;
+	k_spinlock_key_t key = k_spin_lock(&max30102_int_lock);
+	bool valid = max30102_int_time_valid;
+	uint64_t int_time = max30102_int_time;
 
-	uint8_t data[6];
-	ret = d_i2c_read_registers(dev_max30102, 0x07, data, 6);
+	max30102_int_time_valid = false;
+	k_spin_unlock(&max30102_int_lock, key);
 
-	if (!ret) {
-        return -1;
-    }
+	if (valid && !overflow && available >= trigger_samples) {
+		return timestamp_stream_sample(WAVEFORM_PPG, int_time, available - trigger_samples);
+	}
+#endif
+	return read_time;
+}
 
-	if (ret == true){ 
-		sensor_data.head_ptr ++;
-		sensor_data.head_ptr %= DATA_BUFFER_SIZE;	
-		sensor_data.red[sensor_data.head_ptr] = ((data[0] << 16) | (data[1] << 8) | data[2]) & 0x3FFFF;
-		sensor_data.ir[sensor_data.head_ptr] = ((data[3] << 16) | (data[4] << 8) | data[5]) & 0x3FFFF;
+/*
+ * @brief Tell a full FIFO from an empty one when the write and read pointers are equal
+ * @details FIFO_O_CNTR only counts samples lost after the FIFO filled, so a FIFO
+ *          holding exactly MAX30102_FIFO_DEPTH samples reads like an empty one.
+ *          It is full if the almost full interrupt fired since the last drain,
+ *          or if a whole FIFO of samples fits in the time since then
+ */
+static bool max30102_fifo_full(uint64_t read_time)
+{
+#ifdef MAX30102_USE_INTERRUPT
+	k_spinlock_key_t key = k_spin_lock(&max30102_int_lock);
+	bool fired = max30102_int_time_valid;
+
+	k_spin_unlock(&max30102_int_lock, key);
+	if (fired) {
+		return true;
 	}
-	return 6;
+#endif
+	return timestamp_stream_sample(WAVEFORM_PPG, max30102_drain_time, MAX30102_FIFO_DEPTH) <= read_time;
 }
 
-int bufferLength = BUFFERLENGTH; //buffer length of 100 stores 4 seconds of samples running at 25sps
-int spo2 = 0;
-int heartRate = 0;
-int8_t validSPO2 = 0; //indicator to show if the SPO2 calculation is valid
-int8_t validHeartRate = 0; //indicator to show if the heart rate calculation is valid
+/*
+ * @brief Decode sample @p i of the @p count read from the FIFO and stream it
+ *        as waveform; the last of them was taken at @p newest
+ */
+static void max30102_decode(const uint8_t *data, int i, int count, uint64_t newest,
+			    struct ppg_sample *s)
+{
+	const uint8_t *sample = &data[i * MAX30102_BYTES_PER_SAMPLE];
+
+	s->red = ((sample[0] << 16) | (sample[1] << 8) | sample[2]) & 0x3FFFF;
+	s->ir = ((sample[3] << 16) | (sample[4] << 8) | sample[5]) & 0x3FFFF;
+	// consecutive samples at the measured PPG rate
+	uint64_t taken = timestamp_stream_sample(WAVEFORM_PPG, newest, i - (count - 1));
+	s->timestamp = timestamp_to_ms(taken);
+	waveform_push(WAVEFORM_PPG, (uint32_t)timestamp_to_us(taken),
+		      (const int32_t[]){ s->red, s->ir });
+}
+
+/*
+ * @brief Drain every pending sample from the pulse oximeter FIFO
+ * @details Reads FIFO_WR_PTR, FIFO_O_CNTR and FIFO_RD_PTR in one transaction to
+ *          find how many samples are waiting, then pulls all of them from
+ *          FIFO_DATA in a single burst read. Every sample is streamed as raw
+ *          waveform and decoded in place into the PPG processing ring, as far
+ *          as it has room
+ * @return The number of samples read, or -1 on a bus error
+ */
+int max30102_check(const struct i2c_dt_spec *dev_max30102)
+{
+	static uint8_t data[MAX30102_FIFO_DEPTH * MAX30102_BYTES_PER_SAMPLE];
+	uint8_t ptrs[3]; // FIFO_WR_PTR, FIFO_O_CNTR, FIFO_RD_PTR
+
+	if (!d_i2c_read_registers(dev_max30102, MAX30102_FIFO_WR_PTR, ptrs, sizeof(ptrs))) {
+		return -1;
+	}
+	uint64_t read_time = timestamp_now();
+
+	int available = (ptrs[0] - ptrs[2]) & (MAX30102_FIFO_DEPTH - 1);
+	bool overflow = available == 0 && ptrs[1] != 0;
+	if (overflow) {
+		// write pointer caught up with the read pointer: FIFO is full and samples were lost
+		available = MAX30102_FIFO_DEPTH;
+		max30102_overflow_count += ptrs[1];
+		timestamp_stream_restart(WAVEFORM_PPG);
+	} else if (available == 0 && max30102_fifo_full(read_time)) {
+		// full, but nothing lost yet
+		available = MAX30102_FIFO_DEPTH;
+	}
+	max30102_drain_time = read_time;
+	uint64_t newest = max30102_newest_time(available, overflow, read_time);
+	if (available == 0) {
+		return 0;
+	}
+
+	if (!d_i2c_read_registers(dev_max30102, MAX30102_FIFO_DATA, data, available * MAX30102_BYTES_PER_SAMPLE)) {
+		return -1;
+	}
+	timestamp_stream_block(WAVEFORM_PPG, newest, available);
+
+	// the ring is only full while the DSP lags behind; those samples are dropped
+	// from processing and counted, the waveform still gets them
+	int queued = MIN(available, (int)ppg_dsp_space());
+	int i = 0;
 
-uint32_t irBuffer[BUFFERLENGTH]; // infrared LED sensor data
-uint32_t redBuffer[BUFFERLENGTH]; // red LED sensor data
+	// a wrapped ring takes two spans
+	while (i < queued) {
+		struct ppg_sample *span;
+		int count = MIN((int)ppg_dsp_write_span(&span), queued - i);
+
+		for (int n = 0; n < count; n++, i++) {
+			max30102_decode(data, i, available, newest, &span[n]);
+		}
+		ppg_dsp_commit(count);
+	}
+	for (; i < available; i++) {
+		struct ppg_sample dropped;
+
+		max30102_decode(data, i, available, newest, &dropped);
+	}
+	ppg_dsp_drop(available - queued);
+	return available;
+}
 
 int gpio_led_setup(const struct gpio_dt_spec *led0) {
 	if(!gpio_is_ready_dt(led0)) printk("GPIO is not ready\n");
@@ -234,46 +388,120 @@ int gpio_led_toggle(const struct gpio_dt_spec *led0) {
 	return 0;
 }
 
-int max30102_available(void)
+static const struct i2c_dt_spec max30102_spec = MAX30102_DT_SPEC;
+
+#ifdef MAX30102_USE_INTERRUPT
+static const struct gpio_dt_spec max30102_int = MAX30102_INT_DT_SPEC;
+static struct gpio_callback max30102_int_cb;
+static K_SEM_DEFINE(max30102_int_sem, 0, 1);
+static K_SEM_DEFINE(max30102_start_sem, 0, 1);
+
+static const struct i2c_dt_spec *max30102_acq_dev;
+
+static void max30102_int_handler(const struct device *port, struct gpio_callback *cb, gpio_port_pins_t pins)
 {
-	int numSamples = sensor_data.head_ptr - sensor_data.tail_ptr;
-	if (numSamples < 0) numSamples += DATA_BUFFER_SIZE;
-	return numSamples;
+	k_spinlock_key_t key = k_spin_lock(&max30102_int_lock);
+
+	max30102_int_time = timestamp_now();
+	max30102_int_time_valid = true;
+	k_spin_unlock(&max30102_int_lock, key);
+
+	k_sem_give(&max30102_int_sem);
 }
 
-void max30102_next_sample(void)
+/*
+ * @brief Acquisition thread: sleeps until the FIFO almost full interrupt fires,
+ *        then drains the FIFO so the main loop never waits on the PPG sensor
+ */
+static void max30102_acq_thread(void *p1, void *p2, void *p3)
 {
-	if(max30102_available() > 0){
-		sensor_data.tail_ptr++;
-		sensor_data.tail_ptr %= DATA_BUFFER_SIZE;
+	uint8_t status;
+
+	k_sem_take(&max30102_start_sem, K_FOREVER);
+
+	while (1) {
+		// the timeout recovers from a missed edge before the FIFO can overflow
+		if (k_sem_take(&max30102_int_sem, K_MSEC(MAX30102_INT_TIMEOUT_MS)) == 0) {
+			max30102_int_drains++;
+		} else {
+			max30102_timeout_drains++;
+		}
+		if (sensor_registry_wait_running()) {
+			// what the FIFO kept while paused is stale
+			max30102_clear_fifo(max30102_acq_dev);
+			timestamp_stream_restart(WAVEFORM_PPG);
+		}
+
+		// reading clears the interrupt; blocking, so a timed-out read is dequeued before the next
+		d_i2c_read_registers(max30102_acq_dev, MAX30102_INT_STATUS_1, &status, 1);
+
+		if (max30102_check(max30102_acq_dev) < 0) {
+			printk("Failed to read MAX30102 data\n");
+		}
 	}
 }
 
-void max30102_read_data_spo2(const struct i2c_dt_spec * dev_max30102) 
+K_THREAD_DEFINE(max30102_acq_tid, CONFIG_MAX30102_THREAD_STACK_SIZE, max30102_acq_thread,
+		NULL, NULL, NULL, CONFIG_MAX30102_THREAD_PRIORITY, 0, 0);
+
+/*
+ * @brief Configure the INT pin and release the acquisition thread
+ */
+void max30102_start_acquisition(const struct i2c_dt_spec *dev_max30102)
 {
-	for(int i = 0; i < bufferLength; i++)
-	{
-		while(max30102_available() == 0) {
-			if (max30102_check(dev_max30102) < 0) {
-            	printk("Failed to read MAX30102 data\n");
-        		aggregator_add_int(0.0f);
-            	return;  
-       		}
-		}
+	if (!gpio_is_ready_dt(&max30102_int)) {
+		printk("MAX30102 INT GPIO is not ready\n");
+		return;
+	}
+	if (gpio_pin_configure_dt(&max30102_int, GPIO_INPUT) < 0 ||
+	    gpio_pin_interrupt_configure_dt(&max30102_int, GPIO_INT_EDGE_TO_ACTIVE) < 0) {
+		printk("Failed to configure MAX30102 INT pin\n");
+		return;
+	}
+	gpio_init_callback(&max30102_int_cb, max30102_int_handler, BIT(max30102_int.pin));
+	gpio_add_callback(max30102_int.port, &max30102_int_cb);
 
-		redBuffer[i] = sensor_data.red[sensor_data.tail_ptr];
-		irBuffer[i] = sensor_data.ir[sensor_data.tail_ptr];
-		max30102_next_sample();
+	max30102_acq_dev = dev_max30102;
+	k_sem_give(&max30102_start_sem);
+}
 
-		// printk(">red=%d, ir=%d\n", redBuffer[i], irBuffer[i]);
+// self-driven: the FIFO almost full interrupt paces the reads
+#define MAX30102_SENSOR_READ      NULL
+#define MAX30102_SENSOR_PERIOD_MS 0
+#else
+static void max30102_sensor_read(void)
+{
+	// one drain per call; SpO2 is reported by the DSP stage when it publishes
+	if (max30102_check(&max30102_spec) < 0) {
+		printk("Failed to read MAX30102 data\n");
 	}
+}
 
-	//calculate heart rate and SpO2 after first 100 samples (first 4 seconds of samples)
-	maxim_heart_rate_and_oxygen_saturation(irBuffer, bufferLength, redBuffer, &spo2, &validSPO2, &heartRate, &validHeartRate);
+// well inside the MAX30102_FIFO_DEPTH samples the sensor can hold
+#define MAX30102_SENSOR_READ      max30102_sensor_read
+#define MAX30102_SENSOR_PERIOD_MS 100
+#endif
 
-	if (irBuffer[bufferLength-1] < 100000) { // checking IR value to see if finger is placed
-		spo2 = 0;
+static int max30102_sensor_init(void)
+{
+	if (!d_i2c_is_ready(&max30102_spec)) {
+		return -ENODEV;
 	}
+	timestamp_stream_init(WAVEFORM_PPG, FreqS);
+	max30102_default_setup(&max30102_spec);
+	return 0;
+}
+
+SENSOR_DEFINE(max30102, "MAX30102", I2C_BUS0,
+	      max30102_sensor_init, MAX30102_SENSOR_READ, MAX30102_SENSOR_PERIOD_MS,
+	      SENSOR_FIELD(SPO2));
 
-	aggregator_add_int(spo2);
-}
\ No newline at end of file
+void max30102_print_stats(void)
+{
+#ifdef MAX30102_USE_INTERRUPT
+	printk("MAX30102: %u interrupt drains, %u timeout drains, %u samples lost\n",
+	       max30102_int_drains, max30102_timeout_drains, max30102_overflow_count);
+#else
+	printk("MAX30102: %u samples lost\n", max30102_overflow_count);
+#endif
+}
@@ -11,15 +11,13 @@
 #define MAX30102_NODE DT_NODELABEL(max30102)
 #define MAX30102_DT_SPEC I2C_DT_SPEC_GET(MAX30102_NODE)
 
-#define BUFFERLENGTH 100
+#define MAX30102_INT_NODE DT_PATH(zephyr_user)
+#if DT_NODE_HAS_PROP(MAX30102_INT_NODE, max30102_int_gpios)
+#define MAX30102_INT_DT_SPEC GPIO_DT_SPEC_GET(MAX30102_INT_NODE, max30102_int_gpios)
+#endif
 
-#define DATA_BUFFER_SIZE 32
-typedef struct buffer {
-	    uint32_t red[DATA_BUFFER_SIZE];
-	    uint32_t ir[DATA_BUFFER_SIZE];
-	    uint8_t head_ptr;
-	    uint8_t tail_ptr;
-} sensor_struct;
+// Set to true to print how the FIFO drains were triggered with the other stats
+#define REPORT_MAX30102_STATS false
 
 typedef enum{
 	HEART_RATE = 2,
@@ -30,12 +28,10 @@ typedef enum{
 void max30102_default_setup(const struct i2c_dt_spec *dev_max30102);
 void max30102_pulse_oximeter_setup(const struct i2c_dt_spec *dev_max30102, uint8_t sample_avg, bool fifo_rollover, uint8_t fifo_int_threshold, MAX30102_mode_t mode, int sample_rate, int pulse_width, int adc_range);
 int max30102_check(const struct i2c_dt_spec *dev_max30102);
-
-void max30102_read_data_spo2(const struct i2c_dt_spec *dev_max30102);
-int max30102_available(void);
-void max30102_next_sample(void);
+void max30102_start_acquisition(const struct i2c_dt_spec *dev_max30102);
 
 int gpio_led_setup(const struct gpio_dt_spec *led0);
+void max30102_print_stats(void);
 
 
 #endif 
\ No newline at end of file
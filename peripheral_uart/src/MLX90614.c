@@ -8,6 +8,8 @@
 #include "i2c.h"
 #include "mlx90614.h"
 #include "aggregator.h"
+#include "health_services.h"
+#include "sensor_registry.h"
 
 /**
  * @brief Read a 16-bit register from the MLX90614 sensor.
@@ -22,10 +24,10 @@ int read_mlx90614_register(const struct device *i2c_dev,
                            uint16_t *data)
 {
     uint8_t buffer[3];
-    int ret = i2c_write_read(i2c_dev,
-                             MLX90614_ADDR,
-                             &reg_addr, 1,
-                             buffer, 3);
+    int ret = i2c_read_registers(i2c_dev,
+                                 MLX90614_ADDR,
+                                 reg_addr,
+                                 buffer, 3);
     if (ret < 0) {
         return ret;
     }
@@ -39,8 +41,9 @@ int read_mlx90614_register(const struct device *i2c_dev,
  * @brief Probe and wake the MLX90614 on the I2C bus.
  *
  * @param i2c_dev  I2C device handle
+ * @return 0, or -ENODEV if the sensor does not answer
  */
-void mlx90614_init(const struct device *i2c_dev)
+int mlx90614_init(const struct device *i2c_dev)
 {
     uint8_t device_id;
 
@@ -49,15 +52,16 @@ void mlx90614_init(const struct device *i2c_dev)
                           MLX_DEVICE_ID,
                           &device_id) != 0) {
         printk("MLX90614 not detected! (ID=0x%02X)\n", device_id);
-        return;
+        return -ENODEV;
     }
 
     printk("MLX90614 detected (ID=0x%02X)\n", device_id);
     k_msleep(10);
+    return 0;
 }
 
 /**
- * @brief Read ambient and object temperatures, convert to °C, and enqueue as JSON.
+ * @brief Read ambient and object temperatures, convert to °C, and aggregate them.
  *
  * @param i2c_dev  I2C device handle
  */
@@ -71,7 +75,7 @@ void read_mlx90614_data(const struct device *i2c_dev)
     /* Ambient temperature */
     if (read_mlx90614_register(i2c_dev, MLX90614_TA, &ambient_raw) == 0) {
         ambient_c = ambient_raw * 0.02f - 273.15f;  // Convert to °C
-        aggregator_add_float((double)ambient_c);
+        aggregator_add_float(TELEMETRY_AMBIENT_TEMP, (double)ambient_c);
     } else {
         printk("Failed to read MLX90614 data\n");
         return;
@@ -80,11 +84,26 @@ void read_mlx90614_data(const struct device *i2c_dev)
     /* Object temperature */
     if (read_mlx90614_register(i2c_dev, MLX90614_TOBJ1, &object_raw) == 0) {
         object_c = object_raw * 0.02f - 273.15f;    // Convert to °C
-        aggregator_add_float((double)object_c);
+        aggregator_add_float(TELEMETRY_OBJECT_TEMP, (double)object_c);
+        health_update_temperature(object_raw * 2 - 27315);    // 0.02 K per LSB, in 0.01 °C
     } else {
         printk("Failed to read MLX90614 data\n");
-        aggregator_add_float(0.0f);
-        aggregator_add_float(0.0f);
         return;
     }
 }
+
+static int mlx90614_sensor_init(void)
+{
+    if (!device_is_ready(i2c_dev0)) {
+        return -ENODEV;
+    }
+    return mlx90614_init(i2c_dev0);
+}
+
+static void mlx90614_sensor_read(void)
+{
+    read_mlx90614_data(i2c_dev0);
+}
+
+SENSOR_DEFINE(mlx90614, "MLX90614", I2C_BUS0, mlx90614_sensor_init, mlx90614_sensor_read,
+              CONFIG_MLX90614_PERIOD_MS, SENSOR_FIELD(AMBIENT_TEMP) | SENSOR_FIELD(OBJECT_TEMP));
@@ -2,43 +2,53 @@
 #include <zephyr/drivers/i2c.h>
 #include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
-#include <math.h>
 #include <string.h>
 #include <stdio.h>
 
 #include "mpu6050.h"
 #include "i2c.h"
 #include "aggregator.h"
+#include "waveform.h"
+#include "event_rate.h"
+#include "imu_events.h"
+#include "motion_filter.h"
+#include "sensor_registry.h"
+#include "timestamp.h"
+
+#if defined(CONFIG_MPU6050_INTERRUPT) && defined(MPU6050_INT_DT_SPEC)
+#define MPU6050_USE_INTERRUPT 1
+BUILD_ASSERT(CONFIG_MPU6050_BATCH_SAMPLES * MPU6050_FRAME_SIZE < MPU6050_FIFO_SIZE / 2,
+             "MPU6050 batch must leave FIFO headroom");
+#endif
+
+/* FIFO */
+#define MPU6050_GYRO_RATE   1000    /* gyro output rate (Hz) with the DLPF enabled */
+#define MPU6050_MAX_BURST   16      /* frames per FIFO read transaction */
+
+BUILD_ASSERT(CONFIG_MPU6050_SAMPLE_RATE >= 4 && CONFIG_MPU6050_SAMPLE_RATE <= MPU6050_GYRO_RATE,
+             "MPU6050 sample rate must be 4..1000 Hz");
+
+/* Thresholds are changes over 100 ms, the interval they were tuned on */
+#define DETECTION_LAG      MAX(1, CONFIG_MPU6050_SAMPLE_RATE / 10)
 
 /* ACCELEROMETER */
-#define MAX_STEP_HISTORY   200       /* Number of recent step timestamps to keep */
 #define STEP_WINDOW_MS     20000    /* Time window (ms) for rate calculation */
 #define STEP_DEBOUNCE_MS   400      /* Minimum interval (ms) between steps */
-#define STEP_THRESHOLD     0.25f     /* Minimum change in vector magnitude to count a step */  
+#define STEP_THRESHOLD     IMU_ACCEL_G_TO_LSB(0.25)   /* Minimum change in vector magnitude to count a step */
 
 /* GYROSCOPE */
-#define MAX_GYRO_HISTORY   200     /* how many rotation events to remember */
 #define GYRO_WINDOW_MS     20000    /* same window as steps */
 #define GYRO_DEBOUNCE_MS   400     /* Minimum interval (ms) between rotations */
-#define GYRO_THRESHOLD     30.0f    /* deg/s change needed to count a “swing” */
+#define GYRO_THRESHOLD     IMU_GYRO_DPS_TO_LSB(30.0)  /* change needed to count a “swing” */
 
 /* Step counter state */
 typedef struct {
-    uint32_t last_step_time;                   /* Timestamp of last detected step */
-    float    vector_previous;                  /* Previous acceleration magnitude */
-    float    accel_x, accel_y, accel_z;        /* Latest accel readings (g) */
-    float    gyro_x, gyro_y, gyro_z;           /* Latest gyro readings (°/s) */
-    uint32_t step_timestamps[MAX_STEP_HISTORY];/* Circular buffer of step times */
-    int      step_history_index;               /* Next write index in buffer */
-    uint32_t step_count;                       /* Total step count for last window (unused) */
+    imu_detector_t step_detector;              /* Accel magnitude change detector */
+    event_rate_t steps;                        /* Steps in the last STEP_WINDOW_MS */
     uint32_t rate;                             /* Steps per minute */
-    uint32_t window_start_time;                /* Start time of current window */
-    uint32_t last_activity_time;               /* Last time we detected activity */
 
-    float    prev_gyro_mag;                    /* last gyro‐vector magnitude */
-    uint32_t last_gyro_time;                   /* last time we counted a rotation */
-    uint32_t gyro_timestamps[MAX_GYRO_HISTORY];
-    int      gyro_history_index;
+    imu_detector_t rotation_detector;          /* Gyro magnitude change detector */
+    event_rate_t rotations;                    /* Rotations in the last GYRO_WINDOW_MS */
     uint32_t rotation_rate;                    /* Rotations per minute */
 } StepCounter;
 
@@ -46,9 +56,13 @@ static StepCounter step_counter;
 
 static void init_step_counter(void)
 {
+    uint32_t now = timestamp_to_ms(timestamp_now());
+
     memset(&step_counter, 0, sizeof(step_counter));
-    step_counter.window_start_time = k_uptime_get_32();
-    step_counter.last_activity_time = step_counter.window_start_time;
+    event_rate_init(&step_counter.steps, STEP_WINDOW_MS, now);
+    event_rate_init(&step_counter.rotations, GYRO_WINDOW_MS, now);
+    imu_detector_init(&step_counter.step_detector, STEP_THRESHOLD, STEP_DEBOUNCE_MS, DETECTION_LAG);
+    imu_detector_init(&step_counter.rotation_detector, GYRO_THRESHOLD, GYRO_DEBOUNCE_MS, DETECTION_LAG);
 }
 
 /**
@@ -56,18 +70,11 @@ static void init_step_counter(void)
  *
  * @return Number of steps per minute.
  */
-float calculate_step_rate(void)
-{
-    uint32_t now = k_uptime_get_32();
-    int count = 0;
-    for (int i = 0; i < MAX_STEP_HISTORY; i++) {
-        uint32_t ts = step_counter.step_timestamps[i];
-        if (ts != 0 && (now - ts) <= STEP_WINDOW_MS) {
-            count++;
-        }
-    }
-    step_counter.rate = count * 3.0f;
-    return (float)step_counter.rate;
+static uint32_t calculate_step_rate(void)
+{
+    step_counter.rate = event_rate_per_minute(&step_counter.steps,
+                                              timestamp_to_ms(timestamp_now()));
+    return step_counter.rate;
 }
 
 /**
@@ -75,76 +82,114 @@ float calculate_step_rate(void)
  *
  * @return Rotations per minute.
  */
-float calculate_rotation_rate(void)
-{
-    uint32_t now = k_uptime_get_32();
-    int count = 0;
-    for (int i = 0; i < MAX_GYRO_HISTORY; i++) {
-        uint32_t ts = step_counter.gyro_timestamps[i];
-        if (ts != 0 && (now - ts) <= GYRO_WINDOW_MS) {
-            count++;
-        }
-    }
-    step_counter.rotation_rate = count * 3.0f;
-    return (float)step_counter.rotation_rate;
+static uint32_t calculate_rotation_rate(void)
+{
+    step_counter.rotation_rate = event_rate_per_minute(&step_counter.rotations,
+                                                       timestamp_to_ms(timestamp_now()));
+    return step_counter.rotation_rate;
 }
 
 /**
- * @brief Detect a step from acceleration data.
+ * @brief Detect a step from raw acceleration data.
  *
  * Uses change in vector magnitude and a debounce interval.
  */
-static void process_step_detection(float ax, float ay, float az)
+static void process_step_detection(const int16_t accel[3], uint32_t now)
 {
-    uint32_t now = k_uptime_get_32();
-    float vector = sqrtf(ax*ax + ay*ay + az*az);
-    float delta  = fabsf(vector - step_counter.vector_previous);
-
-    /* If change exceeds threshold and enough time has passed, count a step */
-    if (delta > STEP_THRESHOLD && (now - step_counter.last_step_time) > STEP_DEBOUNCE_MS) {
-        step_counter.last_step_time = now;
-
-        /* Store timestamp in circular buffer */
-        step_counter.step_timestamps[step_counter.step_history_index] = now;
-        step_counter.step_history_index =
-            (step_counter.step_history_index + 1) % MAX_STEP_HISTORY;
+    if (imu_detector_update(&step_counter.step_detector, accel, now)) {
+        event_rate_add(&step_counter.steps, now);
     }
-    step_counter.vector_previous = vector;
 }
 
 /**
- * @brief Detect a rotation from gyroscope data.
+ * @brief Detect a rotation from raw gyroscope data.
  *
  * Uses the change in gyroscope magnitude to detect rotation swings.
  */
-static void process_rotation_detection(float gx, float gy, float gz)
+static void process_rotation_detection(const int16_t gyro[3], uint32_t now)
+{
+    if (imu_detector_update(&step_counter.rotation_detector, gyro, now)) {
+        event_rate_add(&step_counter.rotations, now);
+    }
+}
+
+static uint32_t fifo_resets;
+static uint32_t frames_processed;
+static uint64_t frame_cycles;      /* decode, detection and aggregation, not the I2C reads */
+
+#ifdef MPU6050_USE_INTERRUPT
+/* timestamp_now() of the last data ready pulse, and the pulses since boot */
+static uint64_t mpu6050_int_time;
+static uint32_t mpu6050_int_count;
+static struct k_spinlock mpu6050_int_lock;
+#endif
+
+static void mpu6050_reset_fifo(const struct device *i2c_dev)
+{
+    i2c_write_register(i2c_dev, MPU6050_ADDR, USER_CTRL, 0x04);    /* FIFO_RESET */
+    i2c_write_register(i2c_dev, MPU6050_ADDR, USER_CTRL, 0x40);    /* FIFO_EN */
+    timestamp_stream_restart(WAVEFORM_IMU);
+}
+
+static uint32_t mpu6050_int_pulses(void)
+{
+#ifdef MPU6050_USE_INTERRUPT
+    k_spinlock_key_t key = k_spin_lock(&mpu6050_int_lock);
+    uint32_t pulses = mpu6050_int_count;
+
+    k_spin_unlock(&mpu6050_int_lock, key);
+    return pulses;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Time at which the newest frame in the FIFO was sampled.
+ *
+ * With the data ready interrupt that is the last pulse before the FIFO count
+ * was read, unless another one arrived while it was being read or the pulses
+ * have stopped; otherwise the newest frame is taken to be sampled just now.
+ *
+ * @param pulses_before  mpu6050_int_pulses() before the FIFO count was read
+ */
+static uint64_t mpu6050_newest_time(uint32_t pulses_before)
 {
-    uint32_t now = k_uptime_get_32();
-    float mag   = sqrtf(gx*gx + gy*gy + gz*gz);
-    float delta = fabsf(mag - step_counter.prev_gyro_mag);
+    uint64_t now = timestamp_now();
 
-    if (delta > GYRO_THRESHOLD && (now - step_counter.last_gyro_time) > GYRO_DEBOUNCE_MS) {
-        step_counter.last_gyro_time = now;
+#ifdef MPU6050_USE_INTERRUPT
+    k_spinlock_key_t key = k_spin_lock(&mpu6050_int_lock);
+    bool settled = pulses_before != 0 && mpu6050_int_count == pulses_before;
+    uint64_t int_time = mpu6050_int_time;
 
-        /* Store timestamp in circular buffer */
-        step_counter.gyro_timestamps[step_counter.gyro_history_index] = now;
-        step_counter.gyro_history_index =
-            (step_counter.gyro_history_index + 1) % MAX_GYRO_HISTORY;
+    k_spin_unlock(&mpu6050_int_lock, key);
+    if (settled && timestamp_stream_sample(WAVEFORM_IMU, int_time, 1) >= now) {
+        return int_time;
     }
-    step_counter.prev_gyro_mag = mag;
+#endif
+    return now;
 }
 
+#ifdef MPU6050_USE_INTERRUPT
+static void mpu6050_start_acquisition(const struct device *i2c_dev);
+#endif
+
 /**
  * @brief Initialize the MPU6050 sensor and step counter.
+ *
+ * Samples at CONFIG_MPU6050_SAMPLE_RATE through the DLPF into the on-chip
+ * FIFO, which is drained in bursts of full accel/temp/gyro frames.
+ *
+ * @return 0, or -ENODEV if the sensor does not answer
  */
-void mpu6050_init(const struct device *i2c_dev)
+int mpu6050_init(const struct device *i2c_dev)
 {
     uint8_t device_id;
 
     /* Verify sensor presence */
     if (i2c_read_register(i2c_dev, MPU6050_ADDR, MPU_DEVICE_ID, &device_id) != 0) {
         printk("MPU6050 not detected! (ID=0x%02X)\n", device_id);
-        return;
+        return -ENODEV;
     }
 
     printk("MPU6050 detected (ID=0x%02X)\n", device_id);
@@ -155,66 +200,231 @@ void mpu6050_init(const struct device *i2c_dev)
         printk("Failed to wake up MPU6050\n");
     }
 
+    /* Sample rate = 1 kHz / (1 + SMPLRT_DIV), DLPF bandwidth below half of it */
+    i2c_write_register(i2c_dev, MPU6050_ADDR, SMPLRT_DIV, MPU6050_GYRO_RATE / CONFIG_MPU6050_SAMPLE_RATE - 1);
+    i2c_write_register(i2c_dev, MPU6050_ADDR, MPU_CONFIG, CONFIG_MPU6050_DLPF);
+    i2c_write_register(i2c_dev, MPU6050_ADDR, GYRO_CONFIG, 0x00);  /* ±250 °/s, 131 LSB/(°/s) */
+    i2c_write_register(i2c_dev, MPU6050_ADDR, ACCEL_CONFIG, 0x00); /* ±2 g, 16384 LSB/g */
+
+    /* FIFO: accel + temp + gyro, one 14 byte frame per sample */
+    timestamp_stream_init(WAVEFORM_IMU, CONFIG_MPU6050_SAMPLE_RATE);
+    mpu6050_reset_fifo(i2c_dev);
+    i2c_write_register(i2c_dev, MPU6050_ADDR, FIFO_EN, 0xF8);
+
     /* initialize step_counter state */
     init_step_counter();
+
+#ifdef MPU6050_USE_INTERRUPT
+    /* INT: active high push-pull 50 us pulse, cleared by any read; data ready */
+    i2c_write_register(i2c_dev, MPU6050_ADDR, INT_PIN_CFG, 0x10);
+    i2c_write_register(i2c_dev, MPU6050_ADDR, INT_ENABLE, 0x01);
+    mpu6050_start_acquisition(i2c_dev);
+#endif
+    return 0;
 }
 
 /**
- * @brief Read accelerometer and gyroscope data, detect events, compute rates, and aggregate JSON.
+ * @brief Decode one FIFO frame and feed the step/rotation detectors,
+ *        aggregator and waveform stream.
  */
-void read_mpu6050_data(const struct device *i2c_dev)
+static void mpu6050_process_frame(const uint8_t *frame, uint64_t taken)
 {
+    uint32_t start = k_cycle_get_32();
+    uint32_t timestamp = timestamp_to_ms(taken);
     int16_t accel_raw[3], gyro_raw[3];
-    uint8_t buf[6];
 
-    /* Read accelerometer registers */
-    if (i2c_read_registers(i2c_dev, MPU6050_ADDR, ACCEL_XOUT_H, buf, 6) != 0) {
+    accel_raw[0] = (int16_t)((frame[0] << 8) | frame[1]);
+    accel_raw[1] = (int16_t)((frame[2] << 8) | frame[3]);
+    accel_raw[2] = (int16_t)((frame[4] << 8) | frame[5]);
+    /* frame[6..7] is the die temperature */
+    gyro_raw[0] = (int16_t)((frame[8] << 8) | frame[9]);
+    gyro_raw[1] = (int16_t)((frame[10] << 8) | frame[11]);
+    gyro_raw[2] = (int16_t)((frame[12] << 8) | frame[13]);
+
+    process_step_detection(accel_raw, timestamp);
+    process_rotation_detection(gyro_raw, timestamp);
+
+    motion_filter_add_accel(timestamp, accel_raw);
+
+    waveform_push(WAVEFORM_IMU, (uint32_t)timestamp_to_us(taken),
+                  (const int32_t[]){ accel_raw[0], accel_raw[1], accel_raw[2],
+                                     gyro_raw[0], gyro_raw[1], gyro_raw[2] });
+
+    /* raw LSB, converted to g and deg/s only at the wire scale */
+    aggregator_add_fixed(TELEMETRY_ACCEL_X, accel_raw[0], IMU_ACCEL_LSB_PER_G);
+    aggregator_add_fixed(TELEMETRY_ACCEL_Y, accel_raw[1], IMU_ACCEL_LSB_PER_G);
+    aggregator_add_fixed(TELEMETRY_ACCEL_Z, accel_raw[2], IMU_ACCEL_LSB_PER_G);
+    aggregator_add_fixed(TELEMETRY_GYRO_X, gyro_raw[0], IMU_GYRO_LSB_PER_DPS);
+    aggregator_add_fixed(TELEMETRY_GYRO_Y, gyro_raw[1], IMU_GYRO_LSB_PER_DPS);
+    aggregator_add_fixed(TELEMETRY_GYRO_Z, gyro_raw[2], IMU_GYRO_LSB_PER_DPS);
+
+    frame_cycles += k_cycle_get_32() - start;
+    frames_processed++;
+}
+
+/**
+ * @brief Drain every complete frame from the FIFO in bursts of up to
+ *        MPU6050_MAX_BURST frames, then report the step and rotation rates.
+ *
+ * @return Number of frames read, or -1 on error
+ */
+static int mpu6050_drain_fifo(const struct device *i2c_dev)
+{
+    static uint8_t buf[MPU6050_MAX_BURST * MPU6050_FRAME_SIZE];
+    uint8_t count_buf[2];
+    int frames = 0;
+    uint32_t pulses = mpu6050_int_pulses();
+
+    if (i2c_read_registers(i2c_dev, MPU6050_ADDR, FIFO_COUNTH, count_buf, 2) != 0) {
+        return -1;
+    }
+    uint64_t newest = mpu6050_newest_time(pulses);
+    uint16_t count = (count_buf[0] << 8) | count_buf[1];
+
+    /* a partial frame means the FIFO overflowed and lost frame alignment */
+    if (count % MPU6050_FRAME_SIZE != 0 || count > MPU6050_FIFO_SIZE - MPU6050_FRAME_SIZE) {
+        mpu6050_reset_fifo(i2c_dev);
+        fifo_resets++;
+        printk("MPU6050 FIFO overflow, reset (%u)\n", fifo_resets);
+        return 0;
+    }
+
+    int pending = count / MPU6050_FRAME_SIZE;
+
+    /* consecutive frames at the measured IMU rate */
+    timestamp_stream_block(WAVEFORM_IMU, newest, pending);
+
+    while (pending > 0) {
+        int n = MIN(pending, MPU6050_MAX_BURST);
+
+        if (i2c_read_registers(i2c_dev, MPU6050_ADDR, FIFO_R_W, buf, n * MPU6050_FRAME_SIZE) != 0) {
+            return -1;
+        }
+        for (int i = 0; i < n; i++) {
+            pending--;
+            mpu6050_process_frame(&buf[i * MPU6050_FRAME_SIZE],
+                                  timestamp_stream_sample(WAVEFORM_IMU, newest, -pending));
+        }
+        frames += n;
+    }
+
+    if (frames > 0) {
+        aggregator_add_int(TELEMETRY_STEP_RATE, calculate_step_rate());
+        aggregator_add_int(TELEMETRY_ROTATION_RATE, calculate_rotation_rate());
+    }
+    return frames;
+}
+
+#ifdef MPU6050_USE_INTERRUPT
+static const struct gpio_dt_spec mpu6050_int = MPU6050_INT_DT_SPEC;
+static struct gpio_callback mpu6050_int_cb;
+static atomic_t mpu6050_ready_samples;
+static K_SEM_DEFINE(mpu6050_int_sem, 0, 1);
+static K_SEM_DEFINE(mpu6050_start_sem, 0, 1);
+
+static const struct device *mpu6050_acq_dev;
+
+static void mpu6050_int_handler(const struct device *port, struct gpio_callback *cb, gpio_port_pins_t pins)
+{
+    k_spinlock_key_t key = k_spin_lock(&mpu6050_int_lock);
+
+    mpu6050_int_time = timestamp_now();
+    mpu6050_int_count++;
+    k_spin_unlock(&mpu6050_int_lock, key);
+
+    /* one data ready pulse per sample: wake the thread once per batch */
+    if (atomic_inc(&mpu6050_ready_samples) + 1 >= CONFIG_MPU6050_BATCH_SAMPLES) {
+        k_sem_give(&mpu6050_int_sem);
+    }
+}
+
+/*
+ * @brief Acquisition thread: wakes once CONFIG_MPU6050_BATCH_SAMPLES data
+ *        ready interrupts have arrived and drains the FIFO in bursts
+ */
+static void mpu6050_acq_thread(void *p1, void *p2, void *p3)
+{
+    k_sem_take(&mpu6050_start_sem, K_FOREVER);
+
+    while (1) {
+        /* the timeout recovers from missed pulses well before the FIFO fills */
+        k_sem_take(&mpu6050_int_sem,
+                   K_MSEC(2 * CONFIG_MPU6050_BATCH_SAMPLES * 1000 / CONFIG_MPU6050_SAMPLE_RATE));
+        if (sensor_registry_wait_running()) {
+            /* what the FIFO kept while paused is stale */
+            mpu6050_reset_fifo(mpu6050_acq_dev);
+        }
+        atomic_set(&mpu6050_ready_samples, 0);
+
+        if (mpu6050_drain_fifo(mpu6050_acq_dev) < 0) {
+            printk("Failed to read MPU6050 data\n");
+        }
+    }
+}
+
+K_THREAD_DEFINE(mpu6050_acq_tid, CONFIG_MPU6050_THREAD_STACK_SIZE, mpu6050_acq_thread,
+                NULL, NULL, NULL, CONFIG_MPU6050_THREAD_PRIORITY, 0, 0);
+
+/*
+ * @brief Configure the INT pin and release the acquisition thread
+ */
+static void mpu6050_start_acquisition(const struct device *i2c_dev)
+{
+    if (!gpio_is_ready_dt(&mpu6050_int)) {
+        printk("MPU6050 INT GPIO is not ready\n");
+        return;
+    }
+    if (gpio_pin_configure_dt(&mpu6050_int, GPIO_INPUT) < 0 ||
+        gpio_pin_interrupt_configure_dt(&mpu6050_int, GPIO_INT_EDGE_TO_ACTIVE) < 0) {
+        printk("Failed to configure MPU6050 INT pin\n");
+        return;
+    }
+    gpio_init_callback(&mpu6050_int_cb, mpu6050_int_handler, BIT(mpu6050_int.pin));
+    gpio_add_callback(mpu6050_int.port, &mpu6050_int_cb);
+
+    mpu6050_acq_dev = i2c_dev;
+    k_sem_give(&mpu6050_start_sem);
+}
+
+/* self-driven: the data ready interrupt paces the reads */
+#define MPU6050_SENSOR_READ      NULL
+#define MPU6050_SENSOR_PERIOD_MS 0
+#else
+/**
+ * @brief Drain the FIFO: accelerometer and gyroscope samples since the last
+ *        call, detect events, compute rates, and aggregate them.
+ */
+static void mpu6050_sensor_read(void)
+{
+    if (mpu6050_drain_fifo(i2c_dev1) < 0) {
         printk("Failed to read MPU6050 data\n");
-        aggregator_add_float(0.0f);
-        aggregator_add_float(0.0f);
-        aggregator_add_float(0.0f);
-        aggregator_add_int(0.0f);
-        aggregator_add_float(0.0f);
-        aggregator_add_float(0.0f);
-        aggregator_add_float(0.0f);
-        aggregator_add_int(0.0f);
+    }
+}
+
+/* the 1 kB FIFO holds ~70 frames, drain it well before that */
+#define MPU6050_SENSOR_READ      mpu6050_sensor_read
+#define MPU6050_SENSOR_PERIOD_MS MIN(100, 32 * 1000 / CONFIG_MPU6050_SAMPLE_RATE)
+#endif
+
+static int mpu6050_sensor_init(void)
+{
+    if (!device_is_ready(i2c_dev1)) {
+        return -ENODEV;
+    }
+    return mpu6050_init(i2c_dev1);
+}
+
+SENSOR_DEFINE(mpu6050, "MPU6050", I2C_BUS1, mpu6050_sensor_init,
+              MPU6050_SENSOR_READ, MPU6050_SENSOR_PERIOD_MS,
+              SENSOR_FIELD(ACCEL_X) | SENSOR_FIELD(ACCEL_Y) | SENSOR_FIELD(ACCEL_Z) |
+              SENSOR_FIELD(GYRO_X) | SENSOR_FIELD(GYRO_Y) | SENSOR_FIELD(GYRO_Z) |
+              SENSOR_FIELD(STEP_RATE) | SENSOR_FIELD(ROTATION_RATE));
+
+void mpu6050_print_stats(void)
+{
+    if (frames_processed == 0) {
         return;
     }
-    accel_raw[0] = (int16_t)((buf[0] << 8) | buf[1]);
-    accel_raw[1] = (int16_t)((buf[2] << 8) | buf[3]);
-    accel_raw[2] = (int16_t)((buf[4] << 8) | buf[5]);
-    step_counter.accel_x = accel_raw[0] / 16384.0f;
-    step_counter.accel_y = accel_raw[1] / 16384.0f;
-    step_counter.accel_z = accel_raw[2] / 16384.0f;
-
-    process_step_detection(
-        step_counter.accel_x,
-        step_counter.accel_y,
-        step_counter.accel_z
-    );
-    float step_rate = calculate_step_rate();
-
-    aggregator_add_float(step_counter.accel_x);
-    aggregator_add_float(step_counter.accel_y);
-    aggregator_add_float(step_counter.accel_z);
-    aggregator_add_int(step_rate);
-
-    gyro_raw[0] = (int16_t)((buf[0] << 8) | buf[1]);
-    gyro_raw[1] = (int16_t)((buf[2] << 8) | buf[3]);
-    gyro_raw[2] = (int16_t)((buf[4] << 8) | buf[5]);
-    step_counter.gyro_x = gyro_raw[0] / 131.0f;
-    step_counter.gyro_y = gyro_raw[1] / 131.0f;
-    step_counter.gyro_z = gyro_raw[2] / 131.0f;
-
-    process_rotation_detection(
-        step_counter.gyro_x,
-        step_counter.gyro_y,
-        step_counter.gyro_z
-    );
-    float rotation_rate = calculate_rotation_rate();
-
-    aggregator_add_float(step_counter.gyro_x);
-    aggregator_add_float(step_counter.gyro_y);
-    aggregator_add_float(step_counter.gyro_z);
-    aggregator_add_int(rotation_rate);
+    printk("MPU6050: %u frames, %u cycles/frame, %u FIFO resets\n",
+           frames_processed, (uint32_t)(frame_cycles / frames_processed), fifo_resets);
 }
@@ -3,6 +3,7 @@
 
 #include <zephyr/device.h>
 #include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/gpio.h>
 #include <zephyr/sys/printk.h>
 #include <zephyr/kernel.h>
 #include <stdint.h>
@@ -15,8 +16,30 @@
 #define PWR_MGMT_1   0x6B
 #define ACCEL_XOUT_H 0x3B
 #define GYRO_XOUT_H  0x43
+#define SMPLRT_DIV   0x19
+#define MPU_CONFIG   0x1A
+#define GYRO_CONFIG  0x1B
+#define ACCEL_CONFIG 0x1C
+#define FIFO_EN      0x23
+#define INT_PIN_CFG  0x37
+#define INT_ENABLE   0x38
+#define INT_STATUS   0x3A
+#define USER_CTRL    0x6A
+#define FIFO_COUNTH  0x72
+#define FIFO_R_W     0x74
 
-void mpu6050_init(const struct device *i2c_dev);
-void read_mpu6050_data(const struct device *i2c_dev);
-//void read_mpu6050_data(const struct device *i2c_dev, char *buffer, size_t size);
+// One FIFO frame: accel x/y/z, temperature, gyro x/y/z, big endian
+#define MPU6050_FRAME_SIZE 14
+#define MPU6050_FIFO_SIZE  1024
+
+#define MPU6050_INT_NODE DT_PATH(zephyr_user)
+#if DT_NODE_HAS_PROP(MPU6050_INT_NODE, mpu6050_int_gpios)
+#define MPU6050_INT_DT_SPEC GPIO_DT_SPEC_GET(MPU6050_INT_NODE, mpu6050_int_gpios)
+#endif
+
+// Set to true to print the per-frame processing cost with the other stats
+#define REPORT_IMU_STATS false
+
+int mpu6050_init(const struct device *i2c_dev);
+void mpu6050_print_stats(void);
 #endif
\ No newline at end of file
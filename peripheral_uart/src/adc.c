@@ -3,6 +3,12 @@
  */
 #include "adc.h"
 #include "aggregator.h"
+#include "heart_rate.h"
+#include "waveform.h"
+#include "event_rate.h"
+#include "sensor_registry.h"
+#include "spsc_ring.h"
+#include "timestamp.h"
 #include <math.h>  // Include for exponential calculations if needed
 
 #define ADC_REF_VOLTAGE_MV 600 // Internal reference in mV
@@ -10,8 +16,6 @@
 #define ADC_RESOLUTION 4096     // 12-bit resolution
 #define NUMOFADCCHANNELS 2
 
-extern void send_message_to_bluetooth(const char *message);
-
 /* ADC buffer and sequence configuration */
 static int16_t buf;
 static struct adc_sequence sequence = {
@@ -21,18 +25,29 @@ static struct adc_sequence sequence = {
 
 
 // -----------------Filtering Pulse ------------------
-#define TIME_WINDOW_MS 20000
+#ifdef CONFIG_ADC_CONTINUOUS
+#define PULSE_SAMPLE_RATE CONFIG_ADC_SAMPLE_RATE
+#else
+#define PULSE_SAMPLE_RATE 10 // one read per main loop iteration
+#endif
+// checkForBeat()'s FIR low-pass was designed for 100 sps (-3 dB at ~3 Hz), so faster
+// scans are box-car decimated to about that rate first. The 10 Hz polled reads are
+// below it and lose most of the pulse band in the FIR.
+#define PULSE_FILTER_RATE   100
+#define PULSE_DECIMATION    MAX(1, (PULSE_SAMPLE_RATE + PULSE_FILTER_RATE / 2) / PULSE_FILTER_RATE)
+#define PULSE_BEAT_RATE     (PULSE_SAMPLE_RATE / PULSE_DECIMATION)
+#define PULSE_DC_SHIFT      LOG2CEIL(MAX(2, PULSE_BEAT_RATE / 2))   // ~0.5 s DC time constant
+#define PULSE_REFRACTORY    MAX(1, PULSE_BEAT_RATE / 4)             // 250 ms, caps at 240 BPM
+#define PULSE_MIN_IBI_MS    250
+#define PULSE_MAX_IBI_MS    2000                                    // 30 BPM
+#define PULSE_WINDOW_MS     5000                                    // ~5 beats at rest
+#define PULSE_TIMEOUT_MS    3000                                    // report 0 after this long without a beat
 
-bool peak_detected = false;
-int32_t threshold = 1605; 
-uint16_t buffer_index = 0;
-uint16_t beat_count = 0;
-static int32_t prev_val_heart = 0;
 int32_t bpm_exp = 0;
-uint64_t last_bpm_calc_time = 0;
+static uint32_t last_beat_time = 0;
+static event_rate_t pulse_beats;
 
 // -------- Filtering Respiratory---------------------------------------------   
-#define MAX_PEAKS_BREATH               15     
 #define MIN_PEAK_INTERVAL_MS_BREATH    1000   
 #define BREATH_WINDOW_MS               20000  
 #define MOVING_AVERAGE_WINDOW          5
@@ -40,8 +55,7 @@ uint64_t last_bpm_calc_time = 0;
 int32_t prev_val_moving_avg_breath = 0;
 bool rising_breath = false;
 uint32_t last_peak_time_breath = 0;
-uint32_t peak_timestamps_breath[MAX_PEAKS_BREATH];
-int peak_index_breath = 0;
+static event_rate_t breath_peaks;
 
 /* Moving Average Filter */
 int32_t moving_average_filter_breath(int32_t *buffer, int32_t new_sample) {
@@ -68,52 +82,352 @@ bool detect_peak_breath(int32_t current_value, int32_t prev_value, bool *rising)
 }
 
 void add_peak_timestamp_breath(uint32_t timestamp) {
-    peak_timestamps_breath[peak_index_breath] = timestamp;
-    peak_index_breath = (peak_index_breath + 1) % MAX_PEAKS_BREATH;
+    event_rate_add(&breath_peaks, timestamp);
 }
 
-uint32_t calculate_breathing_rate_windowed(void) {
-    uint32_t now = k_uptime_get();
-    int count = 0;
-    for (int i = 0; i < MAX_PEAKS_BREATH; i++) {
-        uint32_t t = peak_timestamps_breath[i];
-        if ((now - t) <= BREATH_WINDOW_MS) {
-            count++;
-        }
-    }
-    return (uint32_t)(count * 3);
+uint32_t calculate_breathing_rate_windowed(uint32_t now) {
+    return event_rate_per_minute(&breath_peaks, now);
 }
 
 int32_t convert_to_mv(int16_t raw_value) {
     return (int32_t)((raw_value * ADC_REF_VOLTAGE_MV * (1.0 / ADC_GAIN)) / ADC_RESOLUTION);
 }
 
-void adc_init(){
+// Latest processed values, reported by get_adc_data()
+static int32_t latest_breath_avg = 0;
+static int32_t latest_brpm = 0;
+static int32_t latest_pulse_mv = 0;
+
+static void process_respiratory_sample(int32_t val_mv, uint32_t now)
+{
+    int32_t moving_avg_breath = moving_average_filter_breath(&prev_val_moving_avg_breath, val_mv);
+
+    if (detect_peak_breath(moving_avg_breath, prev_val_moving_avg_breath, &rising_breath)) {
+        if (now - last_peak_time_breath >= MIN_PEAK_INTERVAL_MS_BREATH) {
+            last_peak_time_breath = now;
+            add_peak_timestamp_breath(now);
+        }
+    }
+    prev_val_moving_avg_breath = moving_avg_breath;
+
+    latest_breath_avg = moving_avg_breath;
+    latest_brpm = calculate_breathing_rate_windowed(now);
+}
+
+/*
+ * Beat-to-beat pulse rate: every PULSE_DECIMATION samples are averaged and
+ * go through the DC-removal and FIR pipeline of checkForBeat(), and BPM is
+ * computed from the mean inter-beat interval of the beats in the last
+ * PULSE_WINDOW_MS. A gap longer than PULSE_MAX_IBI_MS restarts the window so
+ * it never spans a dropout.
+ */
+static void process_pulse_sample(int32_t val_mv, uint32_t now)
+{
+    static int32_t pulse_sum = 0;
+    static int pulse_count = 0;
+
+    latest_pulse_mv = val_mv;
+
+    pulse_sum += val_mv;
+    if (++pulse_count < PULSE_DECIMATION) {
+        return;
+    }
+    int32_t pulse_mv = pulse_sum / PULSE_DECIMATION;
+    pulse_sum = 0;
+    pulse_count = 0;
+
+    if (checkForBeat(pulse_mv)) {
+        uint32_t ibi = now - last_beat_time;
+
+        if (last_beat_time == 0 || ibi > PULSE_MAX_IBI_MS) {
+            event_rate_init(&pulse_beats, PULSE_WINDOW_MS, now);
+        }
+        if (last_beat_time == 0 || ibi >= PULSE_MIN_IBI_MS) {
+            event_rate_add(&pulse_beats, now);
+            last_beat_time = now;
+        }
+        uint32_t bpm = event_rate_interval_per_minute(&pulse_beats, now);
+        if (bpm > 0) {
+            bpm_exp = bpm;
+        }
+    } else if (now - last_beat_time > PULSE_TIMEOUT_MS) {
+        bpm_exp = 0;
+    }
+}
+
+static void report_adc_data(void)
+{
+    aggregator_add_int(TELEMETRY_BREATH_AVG, latest_breath_avg);
+    aggregator_add_int(TELEMETRY_BREATH_RATE, latest_brpm);
+    aggregator_add_int(TELEMETRY_PULSE_MV, latest_pulse_mv);
+    aggregator_add_int(TELEMETRY_PULSE_BPM, bpm_exp);
+}
+
+#ifdef CONFIG_ADC_CONTINUOUS
+// ---------------- Continuous double-buffered acquisition ----------------
+#define ADC_BLOCK_SAMPLES CONFIG_ADC_BLOCK_SAMPLES
+#define ADC_SAMPLE_PERIOD_US (USEC_PER_SEC / CONFIG_ADC_SAMPLE_RATE)
+// the respiratory filters are tuned for ~10 Hz, so that channel is box-car decimated
+#define RESP_DECIMATION MAX(1, CONFIG_ADC_SAMPLE_RATE / 10)
+
+// Two blocks of interleaved scans; samples of a scan are ordered by ascending channel id
+static int16_t adc_samples[2][ADC_BLOCK_SAMPLES][NUMOFADCCHANNELS];
+static uint8_t adc_buffer_index[NUMOFADCCHANNELS];
+
+// A completed block, handed from the sampling callback to the thread and read in place
+struct adc_block {
+    const int16_t (*scans)[NUMOFADCCHANNELS];
+    uint64_t time;                   // timestamp_now() when the block's last scan completed
+};
+
+SPSC_RING_DEFINE(adc_blocks, struct adc_block, 2);
+
+// pauses between the end of one sequence and the first scan of the next
+static uint32_t adc_restarts;
+static uint64_t adc_gap_cycles;
+static uint64_t adc_gap_max_cycles;
+
+static K_SEM_DEFINE(adc_block_sem, 0, 1);
+static K_SEM_DEFINE(adc_start_sem, 0, 1);
+static struct k_poll_signal adc_done_signal;
+
+static enum adc_action adc_sampling_cb(const struct device *dev,
+                                       const struct adc_sequence *seq,
+                                       uint16_t sampling_index)
+{
+    // a half is complete: hand it over while the other half fills
+    if (sampling_index == ADC_BLOCK_SAMPLES - 1 || sampling_index == 2 * ADC_BLOCK_SAMPLES - 1) {
+        struct adc_block block = {
+            .scans = adc_samples[sampling_index / ADC_BLOCK_SAMPLES],
+            .time = timestamp_now(),
+        };
+
+        // the thread releases a block before the sequence that refills it starts
+        spsc_ring_put(&adc_blocks, &block);
+        if (sampling_index == ADC_BLOCK_SAMPLES - 1) {
+            k_sem_give(&adc_block_sem);
+        }
+    }
+    return ADC_ACTION_CONTINUE;
+}
+
+static const struct adc_sequence_options adc_continuous_options = {
+    .interval_us = ADC_SAMPLE_PERIOD_US,
+    .callback = adc_sampling_cb,
+    .extra_samplings = 2 * ADC_BLOCK_SAMPLES - 1,
+};
+
+static int adc_start_continuous(void)
+{
+    k_poll_signal_reset(&adc_done_signal);
+    return adc_read_async(adc_channels[0].dev, &sequence, &adc_done_signal);
+}
+
+static void adc_process_block(const struct adc_block *block)
+{
+    static int32_t resp_sum = 0;
+    static int resp_count = 0;
+
+    // scans are spaced at the measured rate back from the completion of the last one
+    timestamp_stream_block(WAVEFORM_ADC, block->time, ADC_BLOCK_SAMPLES);
+
+    for (int n = 0; n < ADC_BLOCK_SAMPLES; n++) {
+        const int16_t *scan = block->scans[n];
+        uint64_t taken = timestamp_stream_sample(WAVEFORM_ADC, block->time,
+                                                 n - (ADC_BLOCK_SAMPLES - 1));
+        uint32_t now = timestamp_to_ms(taken);
+        int32_t resp_mv = convert_to_mv(scan[adc_buffer_index[0]]);
+        int32_t pulse_mv = convert_to_mv(scan[adc_buffer_index[1]]);
+
+        waveform_push(WAVEFORM_ADC, (uint32_t)timestamp_to_us(taken), (const int32_t[]){ resp_mv, pulse_mv });
+
+        resp_sum += resp_mv;
+        if (++resp_count == RESP_DECIMATION) {
+            process_respiratory_sample(resp_sum / RESP_DECIMATION, now);
+            resp_sum = 0;
+            resp_count = 0;
+        }
+
+        process_pulse_sample(pulse_mv, now);
+    }
+}
+
+/*
+ * @brief Process every block handed over by the sampling callback
+ */
+static void adc_process_blocks(void)
+{
+    struct adc_block *blocks;
+    uint32_t count;
+
+    while ((count = spsc_ring_read_span(&adc_blocks, (void **)&blocks)) > 0) {
+        for (uint32_t i = 0; i < count; i++) {
+            adc_process_block(&blocks[i]);
+        }
+        spsc_ring_consume(&adc_blocks, count);
+    }
+}
+
+/*
+ * @brief Drop every block handed over by the sampling callback
+ */
+static void adc_discard_blocks(void)
+{
+    struct adc_block *blocks;
+    uint32_t count;
+
+    while ((count = spsc_ring_read_span(&adc_blocks, (void **)&blocks)) > 0) {
+        spsc_ring_consume(&adc_blocks, count);
+    }
+}
+
+/*
+ * Processing thread: the sampling callback hands over block 0 halfway
+ * through the sequence and block 1 at its last scan. Block 1 is processed
+ * once the sequence completes and has been restarted, so the next scan is
+ * only delayed by the thread wake-up latency.
+ *
+ * The ADC API cannot chain a sequence onto the previous one, so there is a
+ * short gap in sampling at every restart. Each gap is measured and reported
+ * to the ADC stream's rate estimate, which leaves it out, and counted for
+ * adc_print_stats().
+ *
+ * While acquisition is paused the running sequence completes unprocessed and
+ * the next one only starts once it resumes; the time in between is reported
+ * as a gap but not counted as one.
+ */
+static void adc_thread(void *p1, void *p2, void *p3)
+{
+    struct k_poll_event done_event = K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_SIGNAL,
+                                                              K_POLL_MODE_NOTIFY_ONLY,
+                                                              &adc_done_signal);
+
+    k_sem_take(&adc_start_sem, K_FOREVER);
+
+    while (1) {
+        k_sem_take(&adc_block_sem, K_FOREVER);
+        // the blocks of a sequence that ran into a pause are stale
+        bool resumed = sensor_registry_wait_running();
+        if (resumed) {
+            adc_discard_blocks();
+        } else {
+            adc_process_blocks();
+        }
+
+        k_poll(&done_event, 1, K_FOREVER);
+        done_event.state = K_POLL_STATE_NOT_READY;
+        if (adc_done_signal.result < 0) {
+            printk("ADC sequence failed (%d)\n", adc_done_signal.result);
+        }
+
+        uint64_t restart = timestamp_now();
+        int err = adc_start_continuous();
+        if (resumed) {
+            adc_discard_blocks();
+        } else {
+            adc_process_blocks();
+        }
+        while (err < 0) {
+            printk("Could not restart ADC sequence (%d)\n", err);
+            k_sleep(K_MSEC(100));
+            restart = timestamp_now();
+            err = adc_start_continuous();
+        }
+
+        // the first scan of a sequence is taken as it starts
+        uint64_t gap = timestamp_stream_gap(WAVEFORM_ADC, restart);
+        if (resumed) {
+            continue;
+        }
+        adc_restarts++;
+        adc_gap_cycles += gap;
+        adc_gap_max_cycles = MAX(adc_gap_max_cycles, gap);
+    }
+}
+
+void adc_print_stats(void)
+{
+    if (adc_restarts == 0) {
+        return;
+    }
+    printk("ADC: %u sequence restarts, gap avg %u us max %u us\n", adc_restarts,
+           (uint32_t)timestamp_to_us(adc_gap_cycles / adc_restarts),
+           (uint32_t)timestamp_to_us(adc_gap_max_cycles));
+}
+
+K_THREAD_DEFINE(adc_tid, CONFIG_ADC_THREAD_STACK_SIZE, adc_thread,
+                NULL, NULL, NULL, CONFIG_ADC_THREAD_PRIORITY, 0, 0);
+#endif /* CONFIG_ADC_CONTINUOUS */
+
+int adc_init(){
+	uint32_t start = timestamp_to_ms(timestamp_now());
+
+	beatDetectorInit(PULSE_DC_SHIFT, PULSE_REFRACTORY);
+	event_rate_init(&breath_peaks, BREATH_WINDOW_MS, start);
+	event_rate_init(&pulse_beats, PULSE_WINDOW_MS, start);
+	timestamp_stream_init(WAVEFORM_ADC, PULSE_SAMPLE_RATE);
+
 	for(int i = 0; i < NUMOFADCCHANNELS; i++){
-		int err = 0;
 		const struct adc_dt_spec *adc_channel = &adc_channels[i];
 		if (!adc_is_ready_dt(adc_channel)) {
 			printk("ADC controller device %s not ready\n", adc_channel->dev->name);
-			return;
+			return -ENODEV;
 		}
 
 		/* Configure ADC channel */
 		int err1 = adc_channel_setup_dt(adc_channel);
 		if (err1 < 0) {
-			printk("Could not setup ADC channel (%d)\n", err);
-			return;
+			printk("Could not setup ADC channel (%d)\n", err1);
+			return err1;
 		}
 
 		/* Initialize ADC sequence */
 		err1 = adc_sequence_init_dt(adc_channel, &sequence);
 		if (err1 < 0) {
-			printk("Could not initialize ADC sequence (%d)\n", err);
-			return;
+			printk("Could not initialize ADC sequence (%d)\n", err1);
+			return err1;
 		}
 	}
+
+#ifdef CONFIG_ADC_CONTINUOUS
+	/* Scan every channel in one sequence, into the double buffer */
+	sequence.channels = 0;
+	for (int i = 0; i < NUMOFADCCHANNELS; i++) {
+		sequence.channels |= BIT(adc_channels[i].channel_id);
+	}
+	for (int i = 0; i < NUMOFADCCHANNELS; i++) {
+		uint32_t lower = sequence.channels & BIT_MASK(adc_channels[i].channel_id);
+		adc_buffer_index[i] = POPCOUNT(lower);
+	}
+	sequence.buffer = adc_samples;
+	sequence.buffer_size = sizeof(adc_samples);
+	sequence.options = &adc_continuous_options;
+
+	k_poll_signal_init(&adc_done_signal);
+	int err = adc_start_continuous();
+	if (err < 0) {
+		printk("Could not start continuous ADC sequence (%d)\n", err);
+		return err;
+	}
+	k_sem_give(&adc_start_sem);
+#endif
+	return 0;
 }
 
+#ifdef CONFIG_ADC_CONTINUOUS
 void get_adc_data() {
+    report_adc_data();
+}
+#else
+void adc_print_stats(void)
+{
+}
+
+void get_adc_data() {
+    int32_t wave_mv[NUMOFADCCHANNELS] = {0};
+    uint64_t taken = timestamp_now();
+    uint32_t now = timestamp_to_ms(taken);
+
     for (int i = 0; i < NUMOFADCCHANNELS; i++) {
         const struct adc_dt_spec *adc_channel = &adc_channels[i];
 
@@ -125,54 +439,22 @@ void get_adc_data() {
             printk("ADC read failed for channel %d (%d)\n", i, err1);
         } else {
             // Convert the raw value to millivolts
-            int32_t BRPM = 0;
             int32_t val_mv = convert_to_mv(buf);
-            
-            if (i == 0) { // Respiratory sensor
-                int32_t moving_avg_breath = moving_average_filter_breath(&prev_val_moving_avg_breath, val_mv);
-
-                if (detect_peak_breath(moving_avg_breath, prev_val_moving_avg_breath, &rising_breath)) {
-                    uint32_t now = k_uptime_get();
-                    if (now - last_peak_time_breath >= MIN_PEAK_INTERVAL_MS_BREATH) {
-                        last_peak_time_breath = now;
-                        add_peak_timestamp_breath(now);
-                    }
-                }
-                prev_val_moving_avg_breath = moving_avg_breath;
-
-                BRPM = calculate_breathing_rate_windowed();
-
-                aggregator_add_int(moving_avg_breath);
-                aggregator_add_int(BRPM);
+            wave_mv[i] = val_mv;
 
+            if (i == 0) { // Respiratory sensor
+                process_respiratory_sample(val_mv, now);
             } else if (i == 1) {// Pulse Sensor
-                uint64_t now = k_uptime_get(); 
-
-                // Peak detection
-                if (val_mv > threshold && prev_val_heart <= threshold && !peak_detected) {
-                    beat_count++;
-                    peak_detected = true;
-                } else if (val_mv < threshold) {
-                    peak_detected = false;
-                }
-
-                prev_val_heart = val_mv;
-
-                uint64_t elapsed_ms = now - last_bpm_calc_time;
-                if (elapsed_ms >= TIME_WINDOW_MS) {
-                    if (beat_count > 0) {
-                        bpm_exp = beat_count * 3;
-                    } else {
-                        bpm_exp = 0;
-                    }
-
-                    beat_count = 0;
-                    last_bpm_calc_time = now;
-                }
-
-                aggregator_add_int(val_mv);
-                aggregator_add_int(bpm_exp);
+                process_pulse_sample(val_mv, now);
             }
         }
     }
-}
\ No newline at end of file
+    timestamp_stream_block(WAVEFORM_ADC, taken, 1);
+    waveform_push(WAVEFORM_ADC, (uint32_t)timestamp_to_us(taken), wave_mv);
+    report_adc_data();
+}
+#endif
+
+SENSOR_DEFINE(adc, "ADC", NULL, adc_init, get_adc_data, 100,
+	      SENSOR_FIELD(BREATH_AVG) | SENSOR_FIELD(BREATH_RATE) |
+	      SENSOR_FIELD(PULSE_MV) | SENSOR_FIELD(PULSE_BPM));
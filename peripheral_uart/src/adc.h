@@ -22,8 +22,6 @@
 
 #include <dk_buttons_and_leds.h>
 
-#include <zephyr/settings/settings.h>
-
 #include <stdio.h>
 #include <string.h>
 
@@ -40,8 +38,12 @@ static const struct adc_dt_spec adc_channels[8] = {
     ADC_DT_SPEC_GET_BY_IDX(DT_PATH(zephyr_user), 7),
     ADC_DT_SPEC_GET_BY_IDX(DT_PATH(zephyr_user), 5),
 };
+// Set to true to print the sampling gaps between continuous ADC sequences
+#define REPORT_ADC_STATS false
+
 int32_t convert_to_mv(int16_t raw_value);
-void adc_init();
+int adc_init();
 void get_adc_data();
+void adc_print_stats(void);
 
 #endif
\ No newline at end of file
@@ -1,44 +1,211 @@
-#include <stdio.h>
+#include <stdint.h>
 #include <string.h>
+#include <zephyr/spinlock.h>
 
-#define AGG_BUFFER_SIZE 128
-static char agg_buffer[AGG_BUFFER_SIZE];
-static int  values_received;
+#include "aggregator.h"
+#include "timestamp.h"
 
-extern void send_message_to_bluetooth(const char *msg);
+BUILD_ASSERT(TELEMETRY_STREAM_COUNT == WAVEFORM_STREAM_COUNT, "stream timing covers every waveform stream");
 
-void aggregator_init(void) {
-    values_received = 0;
-    agg_buffer[0]  = '\0';
+/*
+ * Streaming per-field accumulators, kept in wire units (value * scale) so the
+ * summary is exact and no raw samples are stored. sum_sq is large enough for
+ * 65535 full scale int16 samples per interval.
+ */
+typedef struct {
+    uint16_t count;
+    int16_t  min;
+    int16_t  max;
+    int32_t  sum;
+#ifdef CONFIG_TELEMETRY_STDDEV
+    uint64_t sum_sq;
+#endif
+} agg_field_t;
+
+#ifdef CONFIG_TELEMETRY_STDDEV
+#define AGG_FLAGS TELEMETRY_FLAG_STDDEV
+#else
+#define AGG_FLAGS 0
+#endif
+
+static agg_field_t agg_fields[TELEMETRY_FIELD_COUNT];
+static uint32_t agg_present;
+static uint16_t agg_sequence;
+static uint8_t  agg_frame[TELEMETRY_MAX_FRAME_SIZE];
+static struct k_spinlock agg_lock;
+
+extern void send_frame_to_bluetooth(const uint8_t *data, uint16_t len);
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
 }
 
-void aggregator_add_int(int v) {
-    char tmp[32];
-    // no decimals
-    snprintf(tmp, sizeof(tmp), "%d", v);
-    if (values_received > 0) {
-        strncat(agg_buffer, ",", AGG_BUFFER_SIZE - strlen(agg_buffer) - 1);
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    put_le16(p, v & 0xFFFF);
+    put_le16(p + 2, v >> 16);
+}
+
+static int16_t clamp_int16(int32_t v)
+{
+    if (v > INT16_MAX) return INT16_MAX;
+    if (v < INT16_MIN) return INT16_MIN;
+    return (int16_t)v;
+}
+
+static int32_t div_round(int64_t num, int32_t den)
+{
+    return (int32_t)(num < 0 ? (num - den / 2) / den : (num + den / 2) / den);
+}
+
+#ifdef CONFIG_TELEMETRY_STDDEV
+static uint32_t isqrt64(uint64_t v)
+{
+    uint64_t res = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (v >= res + bit) {
+            v -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
     }
-    strncat(agg_buffer, tmp, AGG_BUFFER_SIZE - strlen(agg_buffer) - 1);
-    values_received++;
+    return (uint32_t)res;
 }
+#endif
 
-void aggregator_add_float(double v) {
-    char tmp[32];
-    // exactly one decimal
-    snprintf(tmp, sizeof(tmp), "%.1f", v);
-    if (values_received > 0) {
-        strncat(agg_buffer, ",", AGG_BUFFER_SIZE - strlen(agg_buffer) - 1);
+static void add_scaled(enum telemetry_field field, int16_t v)
+{
+    agg_field_t *f = &agg_fields[field];
+    k_spinlock_key_t key = k_spin_lock(&agg_lock);
+
+    if (f->count == UINT16_MAX) {
+        k_spin_unlock(&agg_lock, key);
+        return;
     }
-    strncat(agg_buffer, tmp, AGG_BUFFER_SIZE - strlen(agg_buffer) - 1);
-    values_received++;
+    if (f->count == 0 || v < f->min) f->min = v;
+    if (f->count == 0 || v > f->max) f->max = v;
+    f->sum += v;
+#ifdef CONFIG_TELEMETRY_STDDEV
+    f->sum_sq += (uint64_t)((int32_t)v * v);
+#endif
+    f->count++;
+    agg_present |= 1UL << field;
+
+    k_spin_unlock(&agg_lock, key);
+}
+
+void aggregator_init(void) {
+    k_spinlock_key_t key = k_spin_lock(&agg_lock);
+
+    memset(agg_fields, 0, sizeof(agg_fields));
+    agg_present = 0;
+
+    k_spin_unlock(&agg_lock, key);
+}
+
+void aggregator_add_int(enum telemetry_field field, int v) {
+    add_scaled(field, clamp_int16(v * telemetry_field_scale[field]));
+}
+
+void aggregator_add_float(enum telemetry_field field, double v) {
+    double scaled = v * telemetry_field_scale[field];
+    add_scaled(field, clamp_int16((int32_t)(scaled < 0 ? scaled - 0.5 : scaled + 0.5)));
+}
+
+void aggregator_add_fixed(enum telemetry_field field, int16_t raw, int16_t raw_per_unit) {
+    // int16 * int16 cannot overflow
+    int32_t scaled = (int32_t)raw * telemetry_field_scale[field];
+    int32_t v = scaled < 0 ? (scaled - raw_per_unit / 2) / raw_per_unit
+                           : (scaled + raw_per_unit / 2) / raw_per_unit;
+    add_scaled(field, clamp_int16(v));
 }
 
+/**
+ * @brief Send the count, mean, min, max (and stddev) of every field added
+ *        since the last call, then start a new reporting interval.
+ */
 void aggregator_finalize_and_send(void) {
-    if (values_received == 0) {
+    agg_field_t fields[TELEMETRY_FIELD_COUNT];
+    uint32_t present;
+    uint64_t now = timestamp_now();
+
+    // snapshot and reset under the lock so producers are held off only for a copy
+    k_spinlock_key_t key = k_spin_lock(&agg_lock);
+    memcpy(fields, agg_fields, sizeof(fields));
+    present = agg_present;
+    memset(agg_fields, 0, sizeof(agg_fields));
+    agg_present = 0;
+    k_spin_unlock(&agg_lock, key);
+
+    if (present == 0) {
         return;
     }
-    strncat(agg_buffer, "\n", AGG_BUFFER_SIZE - strlen(agg_buffer) - 1);
-    send_message_to_bluetooth(agg_buffer);
-    aggregator_init();
+
+    uint8_t *p = agg_frame;
+    *p++ = TELEMETRY_VERSION;
+    *p++ = TELEMETRY_SCHEMA_ID;
+    put_le16(p, agg_sequence++);
+    p += 2;
+    put_le16(p, present & 0xFFFF);
+    put_le16(p + 2, present >> 16);
+    p += 4;
+    *p++ = AGG_FLAGS;
+    uint64_t now_us = timestamp_to_us(now);
+    put_le32(p, (uint32_t)now_us);
+    put_le32(p + 4, (uint32_t)(now_us >> 32));
+    p += 8;
+
+    // where each stream stood when the interval closed
+    uint8_t *stream_mask = p++;
+    *stream_mask = 0;
+    for (int stream = 0; stream < WAVEFORM_STREAM_COUNT; stream++) {
+        struct timestamp_stream_info info;
+
+        if (!timestamp_stream_get(stream, &info)) {
+            continue;
+        }
+        *stream_mask |= BIT(stream);
+        put_le32(p, (uint32_t)info.last_us);
+        put_le32(p + 4, info.rate_mhz);
+        p += TELEMETRY_TIMING_SIZE;
+    }
+
+    for (int field = 0; field < TELEMETRY_FIELD_COUNT; field++) {
+        if (!(present & (1UL << field))) {
+            continue;
+        }
+        const agg_field_t *f = &fields[field];
+
+        *p++ = f->count > UINT8_MAX ? UINT8_MAX : f->count;
+        put_le16(p, (uint16_t)div_round(f->sum, f->count));
+        put_le16(p + 2, (uint16_t)f->min);
+        put_le16(p + 4, (uint16_t)f->max);
+        p += 6;
+#ifdef CONFIG_TELEMETRY_STDDEV
+        // population variance: (n * sum_sq - sum^2) / n^2
+        uint64_t n = f->count;
+        uint64_t sum_abs = f->sum < 0 ? -(int64_t)f->sum : f->sum;
+        uint64_t var_n2 = n * f->sum_sq - sum_abs * sum_abs;
+        const int frac = 2 * TELEMETRY_STDDEV_FRAC_BITS;
+        uint64_t var_frac = var_n2 < (UINT64_MAX >> frac) ? (var_n2 << frac) / (n * n)
+                                                          : ((var_n2 / n) << frac) / n;
+        uint32_t stddev = isqrt64(var_frac);
+        put_le16(p, stddev > UINT16_MAX ? UINT16_MAX : stddev);
+        p += 2;
+#endif
+    }
+
+    put_le16(p, telemetry_crc16(agg_frame, p - agg_frame));
+    p += TELEMETRY_CRC_SIZE;
+
+    send_frame_to_bluetooth(agg_frame, p - agg_frame);
 }
@@ -1,9 +1,13 @@
 #ifndef AGGREGATOR_H
 #define AGGREGATOR_H
 
+#include "telemetry_schema.h"
+
 void aggregator_init(void);
-void aggregator_add_int(int v);
-void aggregator_add_float(double v);
+void aggregator_add_int(enum telemetry_field field, int v);
+void aggregator_add_float(enum telemetry_field field, double v);
+// add raw / raw_per_unit physical units, in 32 bit integer math
+void aggregator_add_fixed(enum telemetry_field field, int16_t raw, int16_t raw_per_unit);
 void aggregator_finalize_and_send(void);
 
 #endif // AGGREGATOR_H
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+
+#include "ble_link.h"
+
+/*
+ * Link layer tuning of the single peripheral connection: once connected we ask
+ * for the largest ATT MTU, LE data length extension and the 2M PHY, then keep
+ * requesting the connection interval of the active profile.
+ *
+ * Intervals are in 1.25 ms units, supervision timeout in 10 ms units.
+ */
+#define STREAM_INTERVAL_MIN   6     // 7.5 ms
+#define STREAM_INTERVAL_MAX   12    // 15 ms
+#define STREAM_LATENCY        0
+#define STREAM_TIMEOUT        400   // 4 s
+
+#define SUMMARY_INTERVAL_MIN  80    // 100 ms
+#define SUMMARY_INTERVAL_MAX  160   // 200 ms
+#define SUMMARY_LATENCY       4
+#define SUMMARY_TIMEOUT       600   // 6 s
+
+#define ATT_NOTIFY_OVERHEAD   3     // opcode + handle
+
+static struct {
+    struct bt_conn *conn;
+    enum ble_link_profile profile;
+    uint16_t interval;
+    uint16_t latency;
+    uint16_t timeout;
+    uint8_t tx_phy;
+    uint16_t tx_max_len;
+    uint32_t tx_bytes;
+    int64_t tx_window_start;
+    uint32_t throughput_bps;
+} link = {
+    .profile = BLE_LINK_PROFILE_SUMMARY,
+};
+
+static atomic_t stream_users;
+static struct bt_gatt_exchange_params mtu_params;
+static struct k_work negotiate_work;
+static struct k_work profile_work;
+
+static const char *phy_str(uint8_t phy)
+{
+    switch (phy) {
+    case BT_GAP_LE_PHY_1M: return "1M";
+    case BT_GAP_LE_PHY_2M: return "2M";
+    case BT_GAP_LE_PHY_CODED: return "Coded";
+    default: return "?";
+    }
+}
+
+static void mtu_exchange_cb(struct bt_conn *conn, uint8_t err,
+                            struct bt_gatt_exchange_params *params)
+{
+    if (err) {
+        printk("MTU exchange failed (err %u)\n", err);
+        return;
+    }
+    printk("ATT MTU %u\n", bt_gatt_get_mtu(conn));
+}
+
+static void negotiate_work_handler(struct k_work *work)
+{
+    struct bt_conn *conn = link.conn;
+    int err;
+
+    if (!conn) {
+        return;
+    }
+
+    mtu_params.func = mtu_exchange_cb;
+    err = bt_gatt_exchange_mtu(conn, &mtu_params);
+    if (err) {
+        printk("MTU exchange request failed (err %d)\n", err);
+    }
+
+    err = bt_conn_le_data_len_update(conn, BT_LE_DATA_LEN_PARAM_MAX);
+    if (err) {
+        printk("Data length update request failed (err %d)\n", err);
+    }
+
+    err = bt_conn_le_phy_update(conn, BT_CONN_LE_PHY_PARAM_2M);
+    if (err) {
+        printk("PHY update request failed (err %d)\n", err);
+    }
+
+    k_work_submit(&profile_work);
+}
+
+static void profile_work_handler(struct k_work *work)
+{
+    static const struct bt_le_conn_param stream_param =
+        BT_LE_CONN_PARAM_INIT(STREAM_INTERVAL_MIN, STREAM_INTERVAL_MAX,
+                              STREAM_LATENCY, STREAM_TIMEOUT);
+    static const struct bt_le_conn_param summary_param =
+        BT_LE_CONN_PARAM_INIT(SUMMARY_INTERVAL_MIN, SUMMARY_INTERVAL_MAX,
+                              SUMMARY_LATENCY, SUMMARY_TIMEOUT);
+    int err;
+
+    if (!link.conn) {
+        return;
+    }
+
+    err = bt_conn_le_param_update(link.conn, link.profile == BLE_LINK_PROFILE_STREAM ?
+                                  &stream_param : &summary_param);
+    if (err && err != -EALREADY) {
+        printk("Connection parameter update request failed (err %d)\n", err);
+    }
+}
+
+static void link_connected(struct bt_conn *conn, uint8_t err)
+{
+    struct bt_conn_info info;
+
+    if (err || link.conn) {
+        return;
+    }
+
+    link.conn = bt_conn_ref(conn);
+    if (bt_conn_get_info(conn, &info) == 0) {
+        link.interval = info.le.interval;
+        link.latency = info.le.latency;
+        link.timeout = info.le.timeout;
+    }
+    link.tx_phy = BT_GAP_LE_PHY_1M;
+    link.tx_max_len = 27;
+    link.tx_bytes = 0;
+    link.tx_window_start = k_uptime_get();
+    link.throughput_bps = 0;
+
+    k_work_submit(&negotiate_work);
+}
+
+static void link_disconnected(struct bt_conn *conn, uint8_t reason)
+{
+    if (conn != link.conn) {
+        return;
+    }
+    bt_conn_unref(link.conn);
+    link.conn = NULL;
+}
+
+static void link_param_updated(struct bt_conn *conn, uint16_t interval,
+                               uint16_t latency, uint16_t timeout)
+{
+    link.interval = interval;
+    link.latency = latency;
+    link.timeout = timeout;
+    printk("Connection interval %u.%02u ms, latency %u, timeout %u ms\n",
+           interval * 5 / 4, (interval * 125) % 100, latency, timeout * 10);
+}
+
+static void link_phy_updated(struct bt_conn *conn, struct bt_conn_le_phy_info *param)
+{
+    link.tx_phy = param->tx_phy;
+    printk("PHY tx %s rx %s\n", phy_str(param->tx_phy), phy_str(param->rx_phy));
+}
+
+static void link_data_len_updated(struct bt_conn *conn, struct bt_conn_le_data_len_info *info)
+{
+    link.tx_max_len = info->tx_max_len;
+    printk("Data length tx %u bytes / %u us\n", info->tx_max_len, info->tx_max_time);
+}
+
+BT_CONN_CB_DEFINE(ble_link_callbacks) = {
+    .connected = link_connected,
+    .disconnected = link_disconnected,
+    .le_param_updated = link_param_updated,
+    .le_phy_updated = link_phy_updated,
+    .le_data_len_updated = link_data_len_updated,
+};
+
+static int ble_link_init(void)
+{
+    k_work_init(&negotiate_work, negotiate_work_handler);
+    k_work_init(&profile_work, profile_work_handler);
+    return 0;
+}
+
+SYS_INIT(ble_link_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
+
+void ble_link_request_stream(enum ble_link_stream_user user, bool active)
+{
+    enum ble_link_profile profile;
+
+    if (active) {
+        atomic_set_bit(&stream_users, user);
+    } else {
+        atomic_clear_bit(&stream_users, user);
+    }
+
+    profile = atomic_get(&stream_users) ? BLE_LINK_PROFILE_STREAM : BLE_LINK_PROFILE_SUMMARY;
+    if (link.profile == profile) {
+        return;
+    }
+    link.profile = profile;
+    k_work_submit(&profile_work);
+}
+
+struct bt_conn *ble_link_conn(void)
+{
+    return link.conn;
+}
+
+uint16_t ble_link_max_payload(void)
+{
+    if (!link.conn) {
+        return 0;
+    }
+    return bt_gatt_get_mtu(link.conn) - ATT_NOTIFY_OVERHEAD;
+}
+
+void ble_link_account_tx(uint16_t bytes)
+{
+    int64_t now = k_uptime_get();
+    int64_t elapsed = now - link.tx_window_start;
+
+    link.tx_bytes += bytes;
+    // throughput over windows of at least one second
+    if (elapsed >= 1000) {
+        link.throughput_bps = (uint32_t)(((uint64_t)link.tx_bytes * 8 * 1000) / elapsed);
+        link.tx_bytes = 0;
+        link.tx_window_start = now;
+    }
+}
+
+uint32_t ble_link_throughput_bps(void)
+{
+    return link.throughput_bps;
+}
+
+void ble_link_print_stats(void)
+{
+    if (!link.conn) {
+        printk("BLE: not connected\n");
+        return;
+    }
+    printk("BLE: %s profile, MTU %u, data length %u, PHY %s, interval %u.%02u ms, latency %u, %u bit/s\n",
+           link.profile == BLE_LINK_PROFILE_STREAM ? "stream" : "summary",
+           bt_gatt_get_mtu(link.conn), link.tx_max_len, phy_str(link.tx_phy),
+           link.interval * 5 / 4, (link.interval * 125) % 100, link.latency,
+           link.throughput_bps);
+}
@@ -0,0 +1,34 @@
+#ifndef BLE_LINK_H
+#define BLE_LINK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <zephyr/bluetooth/conn.h>
+
+#define REPORT_BLE_STATS false
+
+// Connection parameter sets requested from the central
+enum ble_link_profile {
+    BLE_LINK_PROFILE_SUMMARY,    // only 1 Hz summary frames: long interval, slave latency
+    BLE_LINK_PROFILE_STREAM,     // a high-rate stream is active: shortest interval
+};
+
+// Modules that need the stream profile while they are active
+enum ble_link_stream_user {
+    BLE_LINK_USER_WAVEFORM,
+    BLE_LINK_USER_BACKFILL,
+};
+
+// The stream profile is requested while any user is active
+void ble_link_request_stream(enum ble_link_stream_user user, bool active);
+
+// Largest notification payload the current connection accepts, 0 if not connected
+uint16_t ble_link_max_payload(void);
+struct bt_conn *ble_link_conn(void);
+
+// Count bytes handed to the stack for the throughput figure
+void ble_link_account_tx(uint16_t bytes);
+uint32_t ble_link_throughput_bps(void);
+void ble_link_print_stats(void);
+
+#endif // BLE_LINK_H
@@ -0,0 +1,265 @@
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/bluetooth/conn.h>
+
+#include "ble_tx.h"
+#include "ble_link.h"
+
+#define QUEUE_DEPTH CONFIG_BLE_TX_QUEUE_DEPTH
+
+BUILD_ASSERT(QUEUE_DEPTH <= 32, "slot bitmap is 32 bits");
+
+// Retry delay after the stack ran out of TX buffers without anything in flight
+#define RETRY_DELAY K_MSEC(10)
+
+struct tx_frame {
+    const struct bt_gatt_attr *attr;
+    uint16_t len;
+    uint16_t offset;        // bytes already handed to the stack
+    uint8_t id;
+    uint8_t data[CONFIG_BLE_TX_MAX_FRAME_SIZE];
+};
+
+static struct tx_frame frames[QUEUE_DEPTH];
+static uint8_t order[QUEUE_DEPTH];     // slot indices, oldest first
+static uint8_t queued_count;
+static uint32_t slots_used;
+static uint8_t next_id;
+static uint8_t in_flight;
+static struct ble_tx_stats stats;
+static struct k_spinlock tx_lock;
+
+static void drain_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(drain_work, drain_work_handler);
+
+static void remove_at(int pos)
+{
+    slots_used &= ~BIT(order[pos]);
+    memmove(&order[pos], &order[pos + 1], queued_count - pos - 1);
+    queued_count--;
+}
+
+// A frame that has started going out must finish, or the receiver loses sync
+static int oldest_droppable(void)
+{
+    if (queued_count == 0) {
+        return -1;
+    }
+    if (frames[order[0]].offset == 0) {
+        return 0;
+    }
+    return queued_count > 1 ? 1 : -1;
+}
+
+static void flush_locked(void)
+{
+    stats.dropped += queued_count;
+    queued_count = 0;
+    slots_used = 0;
+    in_flight = 0;
+}
+
+int ble_tx_send(const struct bt_gatt_attr *attr, const uint8_t *data, uint16_t len)
+{
+    struct bt_conn *conn = ble_link_conn();
+    struct tx_frame *frame = NULL;
+    k_spinlock_key_t key;
+
+    if (len > CONFIG_BLE_TX_MAX_FRAME_SIZE) {
+        return -EMSGSIZE;
+    }
+    if (!conn || !bt_gatt_is_subscribed(conn, attr, BT_GATT_CCC_NOTIFY)) {
+        return -ENOTCONN;
+    }
+
+    key = k_spin_lock(&tx_lock);
+
+    if (queued_count == QUEUE_DEPTH) {
+#ifdef CONFIG_BLE_TX_COALESCE
+        for (int pos = queued_count - 1; pos >= 0; pos--) {
+            struct tx_frame *f = &frames[order[pos]];
+            if (f->attr == attr && f->offset == 0) {
+                frame = f;
+                stats.coalesced++;
+                break;
+            }
+        }
+#endif
+        if (!frame) {
+            int pos = oldest_droppable();
+            if (pos < 0) {
+                stats.dropped++;
+                k_spin_unlock(&tx_lock, key);
+                return 0;
+            }
+            remove_at(pos);
+            stats.dropped++;
+        }
+    }
+
+    if (!frame) {
+        int slot = __builtin_ctz(~slots_used);
+        slots_used |= BIT(slot);
+        order[queued_count++] = slot;
+        frame = &frames[slot];
+    }
+
+    frame->attr = attr;
+    frame->len = len;
+    frame->offset = 0;
+    frame->id = next_id++ & BLE_TX_HDR_ID_MASK;
+    memcpy(frame->data, data, len);
+    stats.queued++;
+
+    k_spin_unlock(&tx_lock, key);
+
+    k_work_schedule(&drain_work, K_NO_WAIT);
+    return 0;
+}
+
+static void notify_complete(struct bt_conn *conn, void *user_data)
+{
+    uintptr_t info = (uintptr_t)user_data;
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+
+    if (in_flight > 0) {
+        in_flight--;
+    }
+    stats.fragments++;
+    if (info & BIT(31)) {
+        stats.sent++;
+    }
+
+    k_spin_unlock(&tx_lock, key);
+
+    ble_link_account_tx(info & 0xFFFF);
+    k_work_schedule(&drain_work, K_NO_WAIT);
+}
+
+/**
+ * @brief Hand queued fragments to the stack until the in-flight limit is hit
+ *        or the stack runs out of buffers; completions reschedule the work.
+ */
+static void drain_work_handler(struct k_work *work)
+{
+    static uint8_t buf[BLE_TX_HDR_SIZE + CONFIG_BLE_TX_MAX_FRAME_SIZE];
+    struct bt_conn *conn = ble_link_conn();
+
+    if (!conn) {
+        k_spinlock_key_t key = k_spin_lock(&tx_lock);
+        flush_locked();
+        k_spin_unlock(&tx_lock, key);
+        return;
+    }
+    bt_conn_ref(conn);
+
+    for (;;) {
+        uint16_t max_payload = ble_link_max_payload();
+
+        if (max_payload <= BLE_TX_HDR_SIZE) {
+            // the link went down meanwhile; tx_disconnected() flushes the queue
+            break;
+        }
+
+        k_spinlock_key_t key = k_spin_lock(&tx_lock);
+
+        if (queued_count == 0 || in_flight >= CONFIG_BLE_TX_MAX_IN_FLIGHT) {
+            k_spin_unlock(&tx_lock, key);
+            break;
+        }
+
+        struct tx_frame *frame = &frames[order[0]];
+        uint16_t max_chunk = max_payload - BLE_TX_HDR_SIZE;
+        uint16_t chunk = MIN(frame->len - frame->offset, max_chunk);
+        bool first = frame->offset == 0;
+        bool last = frame->offset + chunk == frame->len;
+        const struct bt_gatt_attr *attr = frame->attr;
+
+        buf[0] = frame->id | (first ? BLE_TX_HDR_START : 0) | (last ? BLE_TX_HDR_END : 0);
+        memcpy(&buf[1], &frame->data[frame->offset], chunk);
+        // a started frame is neither coalesced nor dropped while the lock is released
+        frame->offset += chunk;
+        in_flight++;
+
+        k_spin_unlock(&tx_lock, key);
+
+        struct bt_gatt_notify_params params = {
+            .attr = attr,
+            .data = buf,
+            .len = BLE_TX_HDR_SIZE + chunk,
+            .func = notify_complete,
+            .user_data = (void *)((uintptr_t)(BLE_TX_HDR_SIZE + chunk) | (last ? BIT(31) : 0)),
+        };
+        int err = bt_gatt_notify_cb(conn, &params);
+
+        key = k_spin_lock(&tx_lock);
+
+        if (err) {
+            in_flight--;
+        }
+        if (err == -ENOMEM || err == -ENOBUFS) {
+            // back-pressure: wait for a completion, or poll if none is pending
+            bool idle = in_flight == 0;
+            frame->offset -= chunk;
+            k_spin_unlock(&tx_lock, key);
+            if (idle) {
+                k_work_schedule(&drain_work, RETRY_DELAY);
+            }
+            break;
+        }
+
+        if (err) {
+            // unsubscribed or disconnected: the rest of the frame is useless
+            stats.dropped++;
+            remove_at(0);
+        } else {
+            if (first && !last) {
+                stats.fragmented++;
+            }
+            if (last) {
+                remove_at(0);
+            }
+        }
+
+        k_spin_unlock(&tx_lock, key);
+    }
+
+    bt_conn_unref(conn);
+}
+
+static void tx_disconnected(struct bt_conn *conn, uint8_t reason)
+{
+    // runs after the link has dropped its connection reference, and flushes the queue
+    k_work_schedule(&drain_work, K_NO_WAIT);
+}
+
+BT_CONN_CB_DEFINE(ble_tx_callbacks) = {
+    .disconnected = tx_disconnected,
+};
+
+int ble_tx_space(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+    int space = QUEUE_DEPTH - queued_count;
+
+    k_spin_unlock(&tx_lock, key);
+    return space;
+}
+
+void ble_tx_get_stats(struct ble_tx_stats *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+    *out = stats;
+    k_spin_unlock(&tx_lock, key);
+}
+
+void ble_tx_print_stats(void)
+{
+    struct ble_tx_stats s;
+
+    ble_tx_get_stats(&s);
+    printk("BLE TX: queued %u, sent %u, fragmented %u (%u notifications), dropped %u, coalesced %u\n",
+           s.queued, s.sent, s.fragmented, s.fragments, s.dropped, s.coalesced);
+}
@@ -0,0 +1,32 @@
+#ifndef BLE_TX_H
+#define BLE_TX_H
+
+#include <stdint.h>
+#include <zephyr/bluetooth/gatt.h>
+
+#include "ble_tx_frame.h"
+
+struct ble_tx_stats {
+    uint32_t queued;        // frames accepted
+    uint32_t sent;          // frames whose last fragment the stack reported sent
+    uint32_t fragmented;    // frames that needed more than one notification
+    uint32_t fragments;     // notifications sent
+    uint32_t dropped;       // frames discarded by the queue policy or a send error
+    uint32_t coalesced;     // queued frames replaced by a newer one
+};
+
+/**
+ * @brief Queue a frame for notification on @p attr.
+ *
+ * @return 0 if queued, -ENOTCONN if no client is subscribed, -EMSGSIZE if the
+ *         frame exceeds CONFIG_BLE_TX_MAX_FRAME_SIZE
+ */
+int ble_tx_send(const struct bt_gatt_attr *attr, const uint8_t *data, uint16_t len);
+
+// Number of frames that can be queued before the full-queue policy applies
+int ble_tx_space(void);
+
+void ble_tx_get_stats(struct ble_tx_stats *out);
+void ble_tx_print_stats(void);
+
+#endif // BLE_TX_H
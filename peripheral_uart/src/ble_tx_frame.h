@@ -0,0 +1,18 @@
+#ifndef BLE_TX_FRAME_H
+#define BLE_TX_FRAME_H
+
+/*
+ * Notification reassembly header, shared by the firmware fragmenter (ble_tx.c)
+ * and the host decoders (tools/telemetry_decode.c, tools/waveform_decode.c).
+ * Plain C only, no Zephyr headers.
+ *
+ * Every notification sent through the queue starts with one reassembly header
+ * byte, followed by up to (ATT MTU - 4) bytes of the frame.
+ */
+
+#define BLE_TX_HDR_START     0x80    // first fragment of a frame
+#define BLE_TX_HDR_END       0x40    // last fragment of a frame
+#define BLE_TX_HDR_ID_MASK   0x3F    // frame counter, same for every fragment of a frame
+#define BLE_TX_HDR_SIZE      1
+
+#endif // BLE_TX_FRAME_H
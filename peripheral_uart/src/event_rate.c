@@ -0,0 +1,97 @@
+#include <string.h>
+
+#include "event_rate.h"
+
+void event_rate_init(event_rate_t *er, uint32_t window_ms, uint32_t now)
+{
+    memset(er, 0, sizeof(*er));
+    er->window_ms = window_ms;
+    er->bucket_ms = window_ms / EVENT_RATE_BUCKETS > 0 ? window_ms / EVENT_RATE_BUCKETS : 1;
+    er->start = now;
+    er->head_start = now;
+}
+
+/*
+ * Slide the newest bucket forward to the one holding @p now, emptying the
+ * buckets it passes. Each bucket is emptied at most once per window.
+ */
+static void advance(event_rate_t *er, uint32_t now)
+{
+    uint32_t elapsed = now - er->head_start;
+
+    if ((int32_t)elapsed < (int32_t)er->bucket_ms) {
+        return;
+    }
+
+    uint32_t steps = elapsed / er->bucket_ms;
+    if (steps >= EVENT_RATE_BUCKETS) {
+        memset(er->count, 0, sizeof(er->count));
+        er->total = 0;
+    } else {
+        for (uint32_t i = 0; i < steps; i++) {
+            er->head = (er->head + 1) % EVENT_RATE_BUCKETS;
+            er->total -= er->count[er->head];
+            er->count[er->head] = 0;
+        }
+    }
+    er->head_start += steps * er->bucket_ms;
+}
+
+void event_rate_add(event_rate_t *er, uint32_t ts)
+{
+    advance(er, ts);
+
+    if (er->count[er->head] == 0) {
+        er->first[er->head] = ts;
+    }
+    if (er->count[er->head] < UINT16_MAX) {
+        er->count[er->head]++;
+        er->total++;
+    }
+    er->last = ts;
+}
+
+uint32_t event_rate_count(event_rate_t *er, uint32_t now)
+{
+    advance(er, now);
+    return er->total;
+}
+
+uint32_t event_rate_per_minute(event_rate_t *er, uint32_t now)
+{
+    advance(er, now);
+
+    uint32_t span = now - er->start;
+    if (span > er->window_ms) {
+        span = er->window_ms;
+    }
+    // a quarter window at least, so the first events after init do not read as a burst
+    if (span < er->window_ms / 4) {
+        span = er->window_ms / 4;
+    }
+    if (span == 0) {
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)er->total * 60000 + span / 2) / span);
+}
+
+uint32_t event_rate_interval_per_minute(event_rate_t *er, uint32_t now)
+{
+    advance(er, now);
+
+    if (er->total < 2) {
+        return 0;
+    }
+
+    // oldest non-empty bucket, at most EVENT_RATE_BUCKETS steps
+    int b = (er->head + 1) % EVENT_RATE_BUCKETS;
+    while (er->count[b] == 0) {
+        b = (b + 1) % EVENT_RATE_BUCKETS;
+    }
+
+    uint32_t span = er->last - er->first[b];
+    if (span == 0) {
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)(er->total - 1) * 60000 + span / 2) / span);
+}
@@ -0,0 +1,61 @@
+#ifndef EVENT_RATE_H
+#define EVENT_RATE_H
+
+#include <stdint.h>
+
+/*
+ * Sliding-window event rate (steps, rotations, breaths, beats), shared by the
+ * firmware and the host tools. Plain C only.
+ *
+ * The window is split into EVENT_RATE_BUCKETS buckets of window_ms / N each,
+ * kept in a ring with a running total. Adding an event and querying the rate
+ * only expire the buckets that slid out since the last call, so both are O(1)
+ * amortized and the window edge is exact to one bucket.
+ *
+ * Timestamps are uptime in ms and may wrap; they must not go backwards by
+ * more than one bucket. Not thread safe, each estimator has one owner.
+ */
+#define EVENT_RATE_BUCKETS 20
+
+typedef struct {
+    uint32_t window_ms;
+    uint32_t bucket_ms;
+    uint32_t start;                         // timestamp of the reset, to scale a partial window
+    uint32_t head_start;                    // start of the newest bucket
+    uint32_t total;                         // events in all buckets
+    uint32_t last;                          // newest event
+    uint16_t count[EVENT_RATE_BUCKETS];
+    uint32_t first[EVENT_RATE_BUCKETS];     // oldest event of each bucket
+    uint8_t  head;
+} event_rate_t;
+
+/**
+ * @brief Empty the window and start measuring at @p now.
+ */
+void event_rate_init(event_rate_t *er, uint32_t window_ms, uint32_t now);
+
+/**
+ * @brief Record one event at @p ts.
+ */
+void event_rate_add(event_rate_t *er, uint32_t ts);
+
+/**
+ * @brief Events in the window ending at @p now.
+ */
+uint32_t event_rate_count(event_rate_t *er, uint32_t now);
+
+/**
+ * @brief Events per minute: the window count scaled by the window length,
+ *        or by the time since init (at least a quarter window) while the
+ *        first window is filling.
+ */
+uint32_t event_rate_per_minute(event_rate_t *er, uint32_t now);
+
+/**
+ * @brief Events per minute from the mean interval between the events in the
+ *        window. Not quantized by the window length, so suited to short
+ *        windows; 0 with fewer than two events.
+ */
+uint32_t event_rate_interval_per_minute(event_rate_t *er, uint32_t now);
+
+#endif // EVENT_RATE_H
@@ -0,0 +1,286 @@
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/fs/fcb.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/uuid.h>
+
+#include "flash_log.h"
+#include "ble_link.h"
+#include "ble_tx.h"
+#include "telemetry_schema.h"
+
+#define FLASH_LOG_AREA_ID     FIXED_PARTITION_ID(storage_partition)
+#define FLASH_LOG_MAGIC       0x4C564C47    // "LVLG"
+#define FLASH_LOG_VERSION     1
+// One entry per erase block of the partition; the FCB counts sectors in 8 bits
+#define FLASH_LOG_ERASE_SIZE  DT_PROP_OR(DT_GPARENT(DT_NODELABEL(storage_partition)), \
+                                         erase_block_size, 4096)
+#define FLASH_LOG_MAX_SECTORS MIN(FIXED_PARTITION_SIZE(storage_partition) / FLASH_LOG_ERASE_SIZE, \
+                                  UINT8_MAX)
+#define RECORD_HDR_SIZE       4
+#define RECORD_MAX_SIZE       (RECORD_HDR_SIZE + TELEMETRY_MAX_FRAME_SIZE)
+
+// Leave room in the TX queue for live frames while backfilling
+#define BACKFILL_RESERVE      2
+#define BACKFILL_RETRY        K_MSEC(20)
+
+#define BT_UUID_LOG_SERVICE_VAL \
+    BT_UUID_128_ENCODE(0x4c560200, 0x5741, 0x5645, 0x8a1e, 0x4c756e617200)
+#define BT_UUID_LOG_CONTROL_VAL \
+    BT_UUID_128_ENCODE(0x4c560201, 0x5741, 0x5645, 0x8a1e, 0x4c756e617200)
+#define BT_UUID_LOG_RECORDS_VAL \
+    BT_UUID_128_ENCODE(0x4c560202, 0x5741, 0x5645, 0x8a1e, 0x4c756e617200)
+
+static struct fcb log_fcb;
+static struct flash_sector log_sectors[FLASH_LOG_MAX_SECTORS];
+static bool log_ready;
+static uint32_t next_seq;      // sequence number of the next record written
+static uint32_t oldest_seq;
+
+static struct {
+    bool active;
+    uint32_t next_seq;         // first sequence number not yet sent
+    struct fcb_entry loc;
+} backfill;
+
+static void backfill_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(backfill_work, backfill_work_handler);
+
+static int read_record(struct fcb_entry *loc, uint8_t *buf, uint16_t size)
+{
+    uint16_t len = MIN(loc->fe_data_len, size);
+
+    if (flash_area_read(log_fcb.fap, FCB_ENTRY_FA_DATA_OFF((*loc)), buf, len)) {
+        return -EIO;
+    }
+    return len;
+}
+
+static uint32_t record_seq(struct fcb_entry *loc)
+{
+    uint8_t hdr[RECORD_HDR_SIZE];
+
+    if (read_record(loc, hdr, sizeof(hdr)) != sizeof(hdr)) {
+        return 0;
+    }
+    return sys_get_le32(hdr);
+}
+
+// Walk the log once to find the oldest and newest sequence numbers
+static void scan_log(void)
+{
+    struct fcb_entry loc = { 0 };
+    bool first = true;
+
+    next_seq = 0;
+    oldest_seq = 0;
+    while (fcb_getnext(&log_fcb, &loc) == 0) {
+        uint32_t seq = record_seq(&loc);
+        if (first) {
+            oldest_seq = seq;
+            first = false;
+        }
+        next_seq = seq + 1;
+    }
+}
+
+int flash_log_init(void)
+{
+    uint32_t sector_cnt = ARRAY_SIZE(log_sectors);
+    int err;
+
+    err = flash_area_get_sectors(FLASH_LOG_AREA_ID, &sector_cnt, log_sectors);
+    if (err == -ENOMEM) {
+        // more (or smaller) sectors than expected: the log uses the first ones
+        sector_cnt = ARRAY_SIZE(log_sectors);
+        err = 0;
+    }
+    if (err) {
+        printk("Flash log: cannot get sectors (err %d)\n", err);
+        return err;
+    }
+
+    log_fcb.f_magic = FLASH_LOG_MAGIC;
+    log_fcb.f_version = FLASH_LOG_VERSION;
+    log_fcb.f_sector_cnt = sector_cnt;
+    log_fcb.f_scratch_cnt = 0;
+    log_fcb.f_sectors = log_sectors;
+
+    err = fcb_init(FLASH_LOG_AREA_ID, &log_fcb);
+    if (err) {
+        // foreign or corrupt contents: start over with an empty log
+        const struct flash_area *fa;
+        if (flash_area_open(FLASH_LOG_AREA_ID, &fa) == 0) {
+            flash_area_erase(fa, 0, fa->fa_size);
+            flash_area_close(fa);
+        }
+        err = fcb_init(FLASH_LOG_AREA_ID, &log_fcb);
+        if (err) {
+            printk("Flash log: init failed (err %d)\n", err);
+            return err;
+        }
+    }
+
+    scan_log();
+    log_ready = true;
+    printk("Flash log: %u sectors, records %u..%u\n", sector_cnt, oldest_seq, next_seq);
+    return 0;
+}
+
+int flash_log_append(const uint8_t *frame, uint16_t len)
+{
+    struct fcb_entry loc;
+    uint8_t hdr[RECORD_HDR_SIZE];
+    int err;
+
+    if (!log_ready) {
+        return -ENODEV;
+    }
+    if (len > TELEMETRY_MAX_FRAME_SIZE) {
+        return -EMSGSIZE;
+    }
+
+    err = fcb_append(&log_fcb, RECORD_HDR_SIZE + len, &loc);
+    if (err == -ENOSPC) {
+        // full: drop the oldest sector and its records
+        err = fcb_rotate(&log_fcb);
+        if (!err) {
+            err = fcb_append(&log_fcb, RECORD_HDR_SIZE + len, &loc);
+        }
+        if (!err) {
+            struct fcb_entry oldest = { 0 };
+            if (fcb_getnext(&log_fcb, &oldest) == 0) {
+                oldest_seq = record_seq(&oldest);
+            }
+        }
+    }
+    if (err) {
+        return err;
+    }
+
+    sys_put_le32(next_seq, hdr);
+    err = flash_area_write(log_fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc), hdr, sizeof(hdr));
+    if (!err) {
+        err = flash_area_write(log_fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc) + RECORD_HDR_SIZE, frame, len);
+    }
+    if (err) {
+        return err;
+    }
+    err = fcb_append_finish(&log_fcb, &loc);
+    if (err) {
+        return err;
+    }
+
+    next_seq++;
+    return 0;
+}
+
+// ---------------- bulk backfill ----------------
+static ssize_t read_control(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                            void *buf, uint16_t len, uint16_t offset)
+{
+    uint8_t range[8];
+
+    sys_put_le32(oldest_seq, &range[0]);
+    sys_put_le32(next_seq, &range[4]);
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, range, sizeof(range));
+}
+
+static void backfill_stop(void)
+{
+    backfill.active = false;
+    ble_link_request_stream(BLE_LINK_USER_BACKFILL, false);
+}
+
+static ssize_t write_control(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                             const void *buf, uint16_t len, uint16_t offset, uint8_t flags)
+{
+    if (offset != 0 || len != sizeof(uint32_t)) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+    if (!log_ready) {
+        return BT_GATT_ERR(BT_ATT_ERR_UNLIKELY);
+    }
+
+    uint32_t seq = sys_get_le32(buf);
+    if (seq == FLASH_LOG_STOP) {
+        backfill_stop();
+        return len;
+    }
+
+    backfill.next_seq = seq;
+    memset(&backfill.loc, 0, sizeof(backfill.loc));
+    backfill.active = true;
+    ble_link_request_stream(BLE_LINK_USER_BACKFILL, true);
+    k_work_reschedule(&backfill_work, K_NO_WAIT);
+    return len;
+}
+
+BT_GATT_SERVICE_DEFINE(log_service,
+    BT_GATT_PRIMARY_SERVICE(BT_UUID_DECLARE_128(BT_UUID_LOG_SERVICE_VAL)),
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(BT_UUID_LOG_CONTROL_VAL),
+                           BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE,
+                           BT_GATT_PERM_READ | BT_GATT_PERM_WRITE,
+                           read_control, write_control, NULL),
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(BT_UUID_LOG_RECORDS_VAL),
+                           BT_GATT_CHRC_NOTIFY, BT_GATT_PERM_NONE, NULL, NULL, NULL),
+    BT_GATT_CCC(NULL, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+);
+
+/*
+ * Sends records from backfill.next_seq on while the TX queue has room. The
+ * position is only a hint: if the sector under it was rotated away the walk
+ * restarts from the oldest record and skips what was already sent.
+ */
+static void backfill_work_handler(struct k_work *work)
+{
+    static uint8_t record[RECORD_MAX_SIZE];
+    bool restarted = false;
+
+    if (!backfill.active) {
+        return;
+    }
+    if (!ble_link_conn()) {
+        backfill_stop();
+        return;
+    }
+
+    while (ble_tx_space() > BACKFILL_RESERVE) {
+        int err = fcb_getnext(&log_fcb, &backfill.loc);
+        if (err == -ENOTSUP) {
+            // caught up with the newest record
+            backfill_stop();
+            return;
+        }
+        if (err) {
+            if (restarted) {
+                break;
+            }
+            memset(&backfill.loc, 0, sizeof(backfill.loc));
+            restarted = true;
+            continue;
+        }
+
+        int len = read_record(&backfill.loc, record, sizeof(record));
+        if (len < RECORD_HDR_SIZE) {
+            continue;
+        }
+        uint32_t seq = sys_get_le32(record);
+        if ((int32_t)(seq - backfill.next_seq) < 0) {
+            continue;
+        }
+
+        err = ble_tx_send(&log_service.attrs[3], record, len);
+        if (err == -ENOTCONN) {
+            backfill_stop();
+            return;
+        }
+        backfill.next_seq = seq + 1;
+    }
+
+    k_work_reschedule(&backfill_work, BACKFILL_RETRY);
+}
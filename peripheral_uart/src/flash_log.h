@@ -0,0 +1,25 @@
+#ifndef FLASH_LOG_H
+#define FLASH_LOG_H
+
+#include <stdint.h>
+
+/*
+ * Circular flash log of telemetry frames produced while no client is
+ * listening, kept in an FCB on storage_partition. A client reads it back
+ * through the log service:
+ *   control (read)    u32 oldest sequence, u32 next sequence to be written
+ *   control (write)   u32 sequence to resume from; FLASH_LOG_STOP stops
+ *   records (notify)  u32 sequence, frame bytes; one record per ble_tx frame
+ */
+#define FLASH_LOG_STOP 0xFFFFFFFF
+
+int flash_log_init(void);
+
+/**
+ * @brief Append one frame to the log, erasing the oldest sector when full.
+ *
+ * @return 0 on success, negative errno otherwise
+ */
+int flash_log_append(const uint8_t *frame, uint16_t len);
+
+#endif // FLASH_LOG_H
@@ -0,0 +1,145 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/uuid.h>
+
+#include "health_services.h"
+#include "ble_link.h"
+
+#define HRS_FLAG_CONTACT_SUPPORTED   0x04
+#define HRS_FLAG_CONTACT_DETECTED    0x02
+#define HRS_BODY_SENSOR_FINGER       0x03
+
+#define SFLOAT_NAN                   0x07FF
+#define HTS_INDICATE_INTERVAL_MS     1000
+
+// ---------------- Heart Rate ----------------
+static ssize_t read_body_sensor(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                                void *buf, uint16_t len, uint16_t offset)
+{
+    static const uint8_t location = HRS_BODY_SENSOR_FINGER;
+
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, &location, sizeof(location));
+}
+
+BT_GATT_SERVICE_DEFINE(hrs_service,
+    BT_GATT_PRIMARY_SERVICE(BT_UUID_HRS),
+    BT_GATT_CHARACTERISTIC(BT_UUID_HRS_MEASUREMENT, BT_GATT_CHRC_NOTIFY,
+                           BT_GATT_PERM_NONE, NULL, NULL, NULL),
+    BT_GATT_CCC(NULL, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+    BT_GATT_CHARACTERISTIC(BT_UUID_HRS_BODY_SENSOR, BT_GATT_CHRC_READ,
+                           BT_GATT_PERM_READ, read_body_sensor, NULL, NULL),
+);
+
+// ---------------- Pulse Oximeter ----------------
+static ssize_t read_plx_features(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                                 void *buf, uint16_t len, uint16_t offset)
+{
+    // no optional features: no measurement status, device status or stored records
+    static const uint8_t features[2] = { 0x00, 0x00 };
+
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, features, sizeof(features));
+}
+
+BT_GATT_SERVICE_DEFINE(plx_service,
+    BT_GATT_PRIMARY_SERVICE(BT_UUID_POS),
+    BT_GATT_CHARACTERISTIC(BT_UUID_GATT_PLX_CM, BT_GATT_CHRC_NOTIFY,
+                           BT_GATT_PERM_NONE, NULL, NULL, NULL),
+    BT_GATT_CCC(NULL, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+    BT_GATT_CHARACTERISTIC(BT_UUID_GATT_PLX_F, BT_GATT_CHRC_READ,
+                           BT_GATT_PERM_READ, read_plx_features, NULL, NULL),
+);
+
+// ---------------- Health Thermometer ----------------
+BT_GATT_SERVICE_DEFINE(hts_service,
+    BT_GATT_PRIMARY_SERVICE(BT_UUID_HTS),
+    BT_GATT_CHARACTERISTIC(BT_UUID_HTS_MEASUREMENT, BT_GATT_CHRC_INDICATE,
+                           BT_GATT_PERM_NONE, NULL, NULL, NULL),
+    BT_GATT_CCC(NULL, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+);
+
+static struct bt_gatt_indicate_params hts_ind_params;
+static uint8_t hts_ind_buf[5];
+static atomic_t hts_indicating;
+static int64_t hts_last_indication;
+
+static bool subscribed(const struct bt_gatt_attr *attr, uint16_t type)
+{
+    struct bt_conn *conn = ble_link_conn();
+
+    return conn && bt_gatt_is_subscribed(conn, attr, type);
+}
+
+// IEEE 11073 16 bit SFLOAT with exponent 0
+static uint16_t sfloat(int32_t value, bool valid)
+{
+    if (!valid || value < -2048 || value > 2047) {
+        return SFLOAT_NAN;
+    }
+    return (uint16_t)value & 0x0FFF;
+}
+
+void health_update_heart_rate(int32_t bpm, bool valid)
+{
+    const struct bt_gatt_attr *attr = &hrs_service.attrs[1];
+    uint8_t meas[2];
+
+    if (!subscribed(attr, BT_GATT_CCC_NOTIFY)) {
+        return;
+    }
+
+    meas[0] = HRS_FLAG_CONTACT_SUPPORTED | (valid ? HRS_FLAG_CONTACT_DETECTED : 0);
+    meas[1] = valid ? CLAMP(bpm, 0, UINT8_MAX) : 0;
+    bt_gatt_notify(NULL, attr, meas, sizeof(meas));
+}
+
+void health_update_spo2(int32_t spo2, bool spo2_valid, int32_t pulse_rate, bool pulse_rate_valid)
+{
+    const struct bt_gatt_attr *attr = &plx_service.attrs[1];
+    uint8_t meas[5];
+
+    if (!subscribed(attr, BT_GATT_CCC_NOTIFY)) {
+        return;
+    }
+
+    meas[0] = 0;    // no fast/slow values, measurement status or pulse amplitude index
+    sys_put_le16(sfloat(spo2, spo2_valid), &meas[1]);
+    sys_put_le16(sfloat(pulse_rate, pulse_rate_valid), &meas[3]);
+    bt_gatt_notify(NULL, attr, meas, sizeof(meas));
+}
+
+static void hts_indicate_done(struct bt_conn *conn, struct bt_gatt_indicate_params *params, uint8_t err)
+{
+    atomic_clear(&hts_indicating);
+}
+
+void health_update_temperature(int32_t centi_celsius)
+{
+    const struct bt_gatt_attr *attr = &hts_service.attrs[1];
+    struct bt_conn *conn = ble_link_conn();
+    int64_t now = k_uptime_get();
+
+    if (now - hts_last_indication < HTS_INDICATE_INTERVAL_MS ||
+        !subscribed(attr, BT_GATT_CCC_INDICATE)) {
+        return;
+    }
+    // one indication at a time, the client confirms each
+    if (!atomic_cas(&hts_indicating, 0, 1)) {
+        return;
+    }
+
+    // flags: Celsius, no time stamp, no temperature type; IEEE 11073 FLOAT with exponent -2
+    hts_ind_buf[0] = 0;
+    sys_put_le32(((uint32_t)(uint8_t)-2 << 24) | ((uint32_t)centi_celsius & 0x00FFFFFF), &hts_ind_buf[1]);
+
+    hts_ind_params.attr = attr;
+    hts_ind_params.func = hts_indicate_done;
+    hts_ind_params.data = hts_ind_buf;
+    hts_ind_params.len = sizeof(hts_ind_buf);
+
+    if (bt_gatt_indicate(conn, &hts_ind_params) == 0) {
+        hts_last_indication = now;
+    } else {
+        atomic_clear(&hts_indicating);
+    }
+}
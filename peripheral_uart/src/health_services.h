@@ -0,0 +1,22 @@
+#ifndef HEALTH_SERVICES_H
+#define HEALTH_SERVICES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Bluetooth SIG Heart Rate (0x180D), Pulse Oximeter (0x1822) and Health
+ * Thermometer (0x1809) services. Each measurement is only encoded and sent
+ * while a client has enabled its CCC.
+ */
+
+void health_update_heart_rate(int32_t bpm, bool valid);
+void health_update_spo2(int32_t spo2, bool spo2_valid, int32_t pulse_rate, bool pulse_rate_valid);
+
+/**
+ * @brief Body temperature in hundredths of a degree Celsius; indicated at most
+ *        once per second.
+ */
+void health_update_temperature(int32_t centi_celsius);
+
+#endif // HEALTH_SERVICES_H
@@ -1,30 +1,48 @@
 #include "heart_rate.h"
 
-// Global variables for signal tracking and filtering
-int16_t IR_AC_Max = 20;
-int16_t IR_AC_Min = -20;
+// Signal tracking and filtering state
+static int16_t IR_AC_Max = 20;
+static int16_t IR_AC_Min = -20;
 
-int16_t IR_AC_Signal_Current = 0;
-int16_t IR_AC_Signal_Previous = 0;
-int16_t IR_AC_Signal_min = 0;
-int16_t IR_AC_Signal_max = 0;
-int16_t IR_Average_Estimated = 0;
+static int16_t IR_AC_Signal_Current = 0;
+static int16_t IR_AC_Signal_Previous = 0;
+static int16_t IR_AC_Signal_min = 0;
+static int16_t IR_AC_Signal_max = 0;
+static int16_t IR_Average_Estimated = 0;
 
-bool positiveEdge = false;
-bool negativeEdge = false;
+static bool positiveEdge = false;
+static bool negativeEdge = false;
 
-int32_t ir_avg_reg = 0;
+static int32_t ir_avg_reg = 0;
 
-int16_t cbuf[32];
-uint8_t offset = 0;
+static int16_t cbuf[32];
+static uint8_t offset = 0;
 
 static const uint16_t FIRCoeffs[12] = {172, 321, 579, 927, 1360, 1858, 2390, 2916, 3391, 3768, 4012, 4096};
 
 // Define a refractory period (in number of samples)
 // Adjust REFRACTORY_PERIOD_SAMPLES based on your sampling rate (e.g., 25 samples for 250ms delay)
 #define REFRACTORY_PERIOD_SAMPLES 25
+static uint16_t refractoryPeriod = REFRACTORY_PERIOD_SAMPLES;
 static uint16_t refractoryCounter = 0;
 
+// DC estimator time constant is 2^dcShift samples
+static uint8_t dcShift = 4;
+
+// Adaptive beat threshold: a cycle must reach a fraction of the running average amplitude
+#define BEAT_MIN_AMPLITUDE 20
+#define BEAT_MAX_AMPLITUDE 3000
+static int32_t amplitudeAverage = 0;
+
+// Configure the detector for a sample rate: DC estimator time constant and refractory period in samples
+void beatDetectorInit(uint8_t dcEstimatorShift, uint16_t refractorySamples)
+{
+  dcShift = dcEstimatorShift;
+  refractoryPeriod = refractorySamples;
+  refractoryCounter = 0;
+  amplitudeAverage = 0;
+}
+
 // Function prototypes
 int16_t averageDCEstimator(int32_t *p, uint16_t x);
 int16_t lowPassFIRFilter(int16_t din);
@@ -60,15 +78,24 @@ bool checkForBeat(int32_t sample)
     negativeEdge = false;
     IR_AC_Signal_max = 0;
 
-    // Only register a beat if the peak-to-peak difference exceeds the threshold
-    // and if the refractory period has elapsed.
-    if ((IR_AC_Max - IR_AC_Signal_min) > 20 &&
-        (IR_AC_Max - IR_AC_Signal_min) < 1000 &&
+    // Only register a beat if the peak-to-peak difference exceeds the adaptive threshold
+    // (half the running average amplitude) and if the refractory period has elapsed.
+    int32_t amplitude = IR_AC_Max - IR_AC_Signal_min;
+    int32_t minAmplitude = amplitudeAverage / 2;
+    if (minAmplitude < BEAT_MIN_AMPLITUDE) minAmplitude = BEAT_MIN_AMPLITUDE;
+
+    if (amplitude > minAmplitude &&
+        amplitude < BEAT_MAX_AMPLITUDE &&
         (refractoryCounter == 0))
     {
       beatDetected = true;
       // Set the refractory counter to avoid re-triggering too soon
-      refractoryCounter = REFRACTORY_PERIOD_SAMPLES;
+      refractoryCounter = refractoryPeriod;
+    }
+
+    // Track the amplitude of every plausible cycle so the threshold follows the signal
+    if (amplitude < BEAT_MAX_AMPLITUDE) {
+      amplitudeAverage += (amplitude - amplitudeAverage) / 8;
     }
   }
 
@@ -98,7 +125,7 @@ bool checkForBeat(int32_t sample)
 // Average DC Estimator using a running exponential average
 int16_t averageDCEstimator(int32_t *p, uint16_t x)
 {
-  *p += ((((long)x << 15) - *p) >> 4);
+  *p += ((((long)x << 15) - *p) >> dcShift);
   return (*p >> 15);
 }
 
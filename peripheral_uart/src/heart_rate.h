@@ -60,7 +60,10 @@
 */
 
 #include <zephyr/sys/printk.h>
+#include <stdbool.h>
+#include <stdint.h>
 
+void beatDetectorInit(uint8_t dcEstimatorShift, uint16_t refractorySamples);
 bool checkForBeat(int32_t sample);
 int16_t averageDCEstimator(int32_t *p, uint16_t x);
 int16_t lowPassFIRFilter(int16_t din);
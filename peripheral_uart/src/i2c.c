@@ -2,93 +2,518 @@
 #include "BMP280.h"
 #include "MPU6050.h"
 #include "MLX90614.h"
+#include "MAX30102.h"
 #include <zephyr/device.h>
 #include <zephyr/drivers/i2c.h>
 #include <zephyr/sys/printk.h>
 #include <zephyr/kernel.h>
+#include <string.h>
 
-static K_MUTEX_DEFINE(i2c0_mutex);
-
-const struct device *i2c_dev0 = DEVICE_DT_GET(DT_NODELABEL(i2c0));
-const struct device *i2c_dev1 = DEVICE_DT_GET(DT_NODELABEL(i2c1));
+const struct device *i2c_dev0 = I2C_BUS0;
+const struct device *i2c_dev1 = I2C_BUS1;
 
 //---------------------------------------------------------
-static inline void lock_if_i2c0(const struct device *dev)
+// Asynchronous transaction engine
+//
+// Every transaction is queued on its bus and started with i2c_transfer_cb(),
+// so a caller never blocks inside the driver and the queue itself serializes
+// all devices sharing a bus. The blocking helpers below are submit + wait,
+// and give up on a transaction that is still queued after a bounded time.
+//
+// The queue is ordered by device priority, then by deadline, so a MAX30102
+// FIFO drain never waits behind queued 1 Hz temperature/pressure reads.
+// A transaction whose deadline has passed is started ahead of that order,
+// earliest deadline first, so a busy high priority device cannot starve
+// the others.
+//
+// Each bus has its own queue and TWIM peripheral, so transfers on i2c0 and
+// i2c1 run in parallel. Bus busy time and the time both were busy at once
+// are tracked to show how much of the acquisition actually overlaps.
+//---------------------------------------------------------
+
+// Scheduling parameters per device address; lower priority value runs first
+static struct i2c_client i2c_clients[] = {
+    { .name = "MAX30102", .addr = DT_REG_ADDR(MAX30102_NODE), .priority = 0, .deadline_ms = 20 },
+    { .name = "MPU6050",  .addr = MPU6050_ADDR,  .priority = 1, .deadline_ms = 50 },
+    { .name = "MLX90614", .addr = MLX90614_ADDR, .priority = 2, .deadline_ms = 1000 },
+    { .name = "BMP280",   .addr = BMP280_ADDR,   .priority = 2, .deadline_ms = 1000 },
+    { .name = "other",    .addr = 0,             .priority = 3, .deadline_ms = 1000 },
+};
+
+static struct k_spinlock i2c_stats_lock;
+
+// number of buses with a transfer in progress, and since when at least two were
+static int i2c_busy_buses;
+static uint32_t i2c_overlap_start;
+static uint64_t i2c_overlap_us;
+
+static struct i2c_client *i2c_find_client(uint16_t addr)
 {
-    if (dev == i2c_dev0) {              
-        k_mutex_lock(&i2c0_mutex, K_FOREVER); 
+    for (size_t i = 0; i < ARRAY_SIZE(i2c_clients) - 1; i++) {
+        if (i2c_clients[i].addr == addr) {
+            return &i2c_clients[i];
+        }
     }
+    return &i2c_clients[ARRAY_SIZE(i2c_clients) - 1];
 }
 
-static inline void unlock_if_i2c0(const struct device *dev)
+static void i2c_update_stats(struct i2c_async_txn *txn, int result)
 {
-    if (dev == i2c_dev0) {
-        k_mutex_unlock(&i2c0_mutex);
+    uint32_t now = k_cycle_get_32();
+    uint32_t latency_us = k_cyc_to_us_floor32(now - txn->submit_cycles);
+    struct i2c_client_stats *stats = &txn->client->stats;
+
+    k_spinlock_key_t key = k_spin_lock(&i2c_stats_lock);
+    stats->transactions++;
+    if (result < 0) {
+        stats->errors++;
+    }
+    if ((int32_t)(now - txn->deadline_cycles) > 0) {
+        stats->missed_deadlines++;
+    }
+    stats->latency_total_us += latency_us;
+    if (latency_us > stats->latency_max_us) {
+        stats->latency_max_us = latency_us;
     }
+    k_spin_unlock(&i2c_stats_lock, key);
 }
 
-static inline void lock_if_i2c0_dt(const struct i2c_dt_spec *spec)
+/**
+ * @brief Copy the scheduling statistics of a device.
+ *
+ * @param name  Device name as listed in i2c_clients[]
+ * @param out   Output statistics
+ * @return 0 on success, -ENOENT for an unknown name
+ */
+int i2c_client_stats_get(const char *name, struct i2c_client_stats *out)
 {
-    lock_if_i2c0(spec->bus);
+    for (size_t i = 0; i < ARRAY_SIZE(i2c_clients); i++) {
+        if (strcmp(i2c_clients[i].name, name) == 0) {
+            k_spinlock_key_t key = k_spin_lock(&i2c_stats_lock);
+            *out = i2c_clients[i].stats;
+            k_spin_unlock(&i2c_stats_lock, key);
+            return 0;
+        }
+    }
+    return -ENOENT;
 }
 
-static inline void unlock_if_i2c0_dt(const struct i2c_dt_spec *spec)
+struct i2c_async_bus {
+    const struct device *dev;
+    const char *name;
+    sys_slist_t queue;
+    struct i2c_async_txn *active;
+    struct k_spinlock lock;
+    uint32_t busy_start;
+    struct i2c_bus_stats stats;
+};
+
+static struct i2c_async_bus i2c_buses[] = {
+    { .dev = I2C_BUS0, .name = "i2c0" },
+    { .dev = I2C_BUS1, .name = "i2c1" },
+};
+
+static void i2c_bus_mark_busy(struct i2c_async_bus *bus)
 {
-    unlock_if_i2c0(spec->bus);
+    uint32_t now = k_cycle_get_32();
+    k_spinlock_key_t key = k_spin_lock(&i2c_stats_lock);
+
+    bus->busy_start = now;
+    if (++i2c_busy_buses == 2) {
+        i2c_overlap_start = now;
+    }
+    k_spin_unlock(&i2c_stats_lock, key);
 }
 
-int i2c_write_register(const struct device *i2c_dev,
-                       uint8_t dev_addr, uint8_t reg_addr, uint8_t data)
+static void i2c_bus_mark_idle(struct i2c_async_bus *bus)
 {
-    uint8_t buf[2] = { reg_addr, data };
-    lock_if_i2c0(i2c_dev);
-    int ret = i2c_write(i2c_dev, buf, sizeof(buf), dev_addr);
-    unlock_if_i2c0(i2c_dev);
-    return ret;
+    uint32_t now = k_cycle_get_32();
+    k_spinlock_key_t key = k_spin_lock(&i2c_stats_lock);
+
+    bus->stats.transactions++;
+    bus->stats.busy_us += k_cyc_to_us_floor32(now - bus->busy_start);
+    if (i2c_busy_buses-- == 2) {
+        i2c_overlap_us += k_cyc_to_us_floor32(now - i2c_overlap_start);
+    }
+    k_spin_unlock(&i2c_stats_lock, key);
 }
 
-int i2c_read_register(const struct device *i2c_dev,
-                      uint8_t dev_addr, uint8_t reg_addr, uint8_t *data)
+/**
+ * @brief Copy the transfer time statistics of a bus.
+ *
+ * @return 0 on success, -EINVAL for an unknown bus
+ */
+int i2c_bus_stats_get(const struct device *i2c_dev, struct i2c_bus_stats *out)
 {
-    lock_if_i2c0(i2c_dev);
-    int ret = i2c_write_read(i2c_dev, dev_addr, &reg_addr, 1, data, 1);
-    unlock_if_i2c0(i2c_dev);
-    return ret;
+    for (size_t i = 0; i < ARRAY_SIZE(i2c_buses); i++) {
+        if (i2c_buses[i].dev == i2c_dev) {
+            k_spinlock_key_t key = k_spin_lock(&i2c_stats_lock);
+            *out = i2c_buses[i].stats;
+            k_spin_unlock(&i2c_stats_lock, key);
+            return 0;
+        }
+    }
+    return -EINVAL;
 }
 
-int i2c_read_registers(const struct device *i2c_dev,
-                       uint8_t dev_addr, uint8_t reg_addr,
-                       uint8_t *data, size_t len)
+/**
+ * @brief Total time at least two buses were transferring at once.
+ */
+uint64_t i2c_overlap_us_get(void)
 {
-    lock_if_i2c0(i2c_dev);
-    int ret = i2c_write_read(i2c_dev, dev_addr, &reg_addr, 1, data, len);
-    unlock_if_i2c0(i2c_dev);
-    return ret;
+    k_spinlock_key_t key = k_spin_lock(&i2c_stats_lock);
+    uint64_t us = i2c_overlap_us;
+    k_spin_unlock(&i2c_stats_lock, key);
+    return us;
 }
 
+/*
+ * @brief Print the transactions and busy time of every bus since the last
+ *        call, and how much of the acquisition time, i.e. the time any bus
+ *        was busy, had two transfers overlapping
+ */
+static void i2c_print_bus_stats(void)
+{
+    static uint64_t last_busy_us[ARRAY_SIZE(i2c_buses)];
+    static uint32_t last_transactions[ARRAY_SIZE(i2c_buses)];
+    static uint64_t last_overlap_us;
+    static int64_t last_print;
+    int64_t now = k_uptime_get();
+    uint64_t window_us = (uint64_t)(now - last_print) * 1000;
+    uint64_t busy_total_us = 0;
 
-void i2c_init(void) {
-    if (!device_is_ready(i2c_dev0)) {
-        printk("I2C0 device not ready\n");
+    if (window_us == 0) {
         return;
     }
+    for (size_t i = 0; i < ARRAY_SIZE(i2c_buses); i++) {
+        struct i2c_bus_stats stats;
+        i2c_bus_stats_get(i2c_buses[i].dev, &stats);
+
+        uint64_t busy_us = stats.busy_us - last_busy_us[i];
+        uint32_t transactions = stats.transactions - last_transactions[i];
+        last_busy_us[i] = stats.busy_us;
+        last_transactions[i] = stats.transactions;
+        busy_total_us += busy_us;
+        printk("%s: %u txns, busy %u us (%u.%u%%)\n", i2c_buses[i].name, transactions,
+               (uint32_t)busy_us, (uint32_t)(busy_us * 100 / window_us),
+               (uint32_t)(busy_us * 1000 / window_us % 10));
+    }
+
+    uint64_t overlap_us = i2c_overlap_us_get();
+    uint64_t window_overlap_us = overlap_us - last_overlap_us;
+    // time any bus was busy; only two buses, so overlap is counted twice in the sum
+    uint64_t acquisition_us = busy_total_us - window_overlap_us;
+    last_overlap_us = overlap_us;
+    last_print = now;
+
+    if (acquisition_us > 0) {
+        printk("I2C overlap: %u us, %u%% of %u us acquisition time\n", (uint32_t)window_overlap_us,
+               (uint32_t)(window_overlap_us * 100 / acquisition_us), (uint32_t)acquisition_us);
+    }
+}
+
+void i2c_print_stats(void)
+{
+    i2c_print_bus_stats();
+
+    for (size_t i = 0; i < ARRAY_SIZE(i2c_clients); i++) {
+        struct i2c_client_stats stats;
+        i2c_client_stats_get(i2c_clients[i].name, &stats);
+        if (stats.transactions == 0) {
+            continue;
+        }
+        printk("%s: %u txns, %u errors, %u missed deadlines, %u timeouts, "
+               "latency avg %u us max %u us\n",
+               i2c_clients[i].name, stats.transactions, stats.errors, stats.missed_deadlines,
+               stats.timeouts, (uint32_t)(stats.latency_total_us / stats.transactions),
+               stats.latency_max_us);
+    }
+}
+
+static struct i2c_async_bus *i2c_async_find_bus(const struct device *dev)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(i2c_buses); i++) {
+        if (i2c_buses[i].dev == dev) {
+            return &i2c_buses[i];
+        }
+    }
+    return NULL;
+}
+
+static void i2c_async_finish(struct i2c_async_bus *bus, int result)
+{
+    k_spinlock_key_t key = k_spin_lock(&bus->lock);
+    struct i2c_async_txn *txn = bus->active;
+    bus->active = NULL;
+    k_spin_unlock(&bus->lock, key);
 
-    if (!device_is_ready(i2c_dev1)) {
-        printk("I2C1 device not ready\n");
+    if (txn == NULL) {
         return;
     }
+    i2c_bus_mark_idle(bus);
+    i2c_update_stats(txn, result);
+    if (txn->cb != NULL) {
+        txn->cb(result, txn->user_data);
+    }
+}
+
+static void i2c_async_transfer_done(const struct device *dev, int result, void *data);
+
+/*
+ * @brief Remove the next transaction to start from the queue: the most overdue
+ *        one if any deadline has passed, otherwise the head. Called with bus->lock held
+ */
+static sys_snode_t *i2c_async_pick_next(struct i2c_async_bus *bus)
+{
+    uint32_t now = k_cycle_get_32();
+    struct i2c_async_txn *queued, *overdue = NULL;
+    sys_snode_t *prev = NULL, *overdue_prev = NULL;
 
-    mpu6050_init(i2c_dev1);
-    mlx90614_init(i2c_dev0);
-    bmp280_init(i2c_dev0);
+    SYS_SLIST_FOR_EACH_CONTAINER(&bus->queue, queued, node) {
+        if ((int32_t)(now - queued->deadline_cycles) > 0 &&
+            (overdue == NULL || (int32_t)(overdue->deadline_cycles - queued->deadline_cycles) > 0)) {
+            overdue = queued;
+            overdue_prev = prev;
+        }
+        prev = &queued->node;
+    }
+    if (overdue == NULL) {
+        return sys_slist_get(&bus->queue);
+    }
+    sys_slist_remove(&bus->queue, overdue_prev, &overdue->node);
+    return &overdue->node;
 }
 
-void i2c_read_data(void) {
-    read_mpu6050_data(i2c_dev1);
-    read_mlx90614_data(i2c_dev0);
-    read_bmp280_data(i2c_dev0);
+static void i2c_async_start_next(struct i2c_async_bus *bus)
+{
+    while (1) {
+        k_spinlock_key_t key = k_spin_lock(&bus->lock);
+        sys_snode_t *node = (bus->active == NULL) ? i2c_async_pick_next(bus) : NULL;
+        if (node == NULL) {
+            k_spin_unlock(&bus->lock, key);
+            return;
+        }
+        struct i2c_async_txn *txn = CONTAINER_OF(node, struct i2c_async_txn, node);
+        bus->active = txn;
+        k_spin_unlock(&bus->lock, key);
+        i2c_bus_mark_busy(bus);
+
+        int ret = -ENOSYS;
+#ifdef CONFIG_I2C_CALLBACK
+        ret = i2c_transfer_cb(bus->dev, txn->msgs, txn->num_msgs, txn->addr,
+                              i2c_async_transfer_done, bus);
+        if (ret == 0) {
+            return; // completion arrives in i2c_async_transfer_done()
+        }
+#endif
+        if (ret == -ENOSYS) {
+            // driver without callback support: run it here, in the submitting thread
+            ret = i2c_transfer(bus->dev, txn->msgs, txn->num_msgs, txn->addr);
+        }
+        i2c_async_finish(bus, ret);
+    }
+}
+
+static void i2c_async_transfer_done(const struct device *dev, int result, void *data)
+{
+    struct i2c_async_bus *bus = data;
+
+    i2c_async_finish(bus, result);
+    i2c_async_start_next(bus);
+}
+
+/**
+ * @brief Queue a prepared transaction on its bus.
+ *
+ * The transaction, its message buffers and @p txn itself must stay valid
+ * until the completion callback has run.
+ *
+ * @return 0 if queued, -EINVAL for an unknown bus
+ */
+int i2c_async_submit(struct i2c_async_txn *txn)
+{
+    struct i2c_async_bus *bus = i2c_async_find_bus(txn->bus);
+    if (bus == NULL) {
+        return -EINVAL;
+    }
+
+    txn->client = i2c_find_client(txn->addr);
+    txn->submit_cycles = k_cycle_get_32();
+    txn->deadline_cycles = txn->submit_cycles + k_ms_to_cyc_ceil32(txn->client->deadline_ms);
+
+    // insert after every transaction of higher or equal priority with an earlier deadline
+    k_spinlock_key_t key = k_spin_lock(&bus->lock);
+    sys_snode_t *prev = NULL;
+    struct i2c_async_txn *queued;
+    SYS_SLIST_FOR_EACH_CONTAINER(&bus->queue, queued, node) {
+        if (queued->client->priority > txn->client->priority ||
+            (queued->client->priority == txn->client->priority &&
+             (int32_t)(queued->deadline_cycles - txn->deadline_cycles) > 0)) {
+            break;
+        }
+        prev = &queued->node;
+    }
+    sys_slist_insert(&bus->queue, prev, &txn->node);
+    k_spin_unlock(&bus->lock, key);
+
+    i2c_async_start_next(bus);
+    return 0;
 }
 
+static void i2c_async_prep(struct i2c_async_txn *txn, const struct device *i2c_dev, uint16_t dev_addr,
+                           i2c_async_cb_t cb, void *user_data)
+{
+    txn->bus = i2c_dev;
+    txn->addr = dev_addr;
+    txn->num_msgs = 0;
+    txn->cb = cb;
+    txn->user_data = user_data;
+}
+
+static void i2c_async_add_msg(struct i2c_async_txn *txn, uint8_t *buf, size_t len, uint8_t flags)
+{
+    txn->msgs[txn->num_msgs].buf = buf;
+    txn->msgs[txn->num_msgs].len = len;
+    txn->msgs[txn->num_msgs].flags = flags;
+    txn->num_msgs++;
+}
+
+int i2c_write_register_async(struct i2c_async_txn *txn, const struct device *i2c_dev,
+                             uint8_t dev_addr, uint8_t reg_addr, uint8_t data,
+                             i2c_async_cb_t cb, void *user_data)
+{
+    i2c_async_prep(txn, i2c_dev, dev_addr, cb, user_data);
+    txn->wbuf[0] = reg_addr;
+    txn->wbuf[1] = data;
+    i2c_async_add_msg(txn, txn->wbuf, 2, I2C_MSG_WRITE | I2C_MSG_STOP);
+    return i2c_async_submit(txn);
+}
+
+int i2c_read_registers_async(struct i2c_async_txn *txn, const struct device *i2c_dev,
+                             uint8_t dev_addr, uint8_t reg_addr, uint8_t *data, size_t len,
+                             i2c_async_cb_t cb, void *user_data)
+{
+    i2c_async_prep(txn, i2c_dev, dev_addr, cb, user_data);
+    txn->wbuf[0] = reg_addr;
+    i2c_async_add_msg(txn, txn->wbuf, 1, I2C_MSG_WRITE);
+    i2c_async_add_msg(txn, data, len, I2C_MSG_RESTART | I2C_MSG_READ | I2C_MSG_STOP);
+    return i2c_async_submit(txn);
+}
+
+int i2c_read_async(struct i2c_async_txn *txn, const struct device *i2c_dev, uint8_t dev_addr,
+                   uint8_t *data, size_t len, i2c_async_cb_t cb, void *user_data)
+{
+    i2c_async_prep(txn, i2c_dev, dev_addr, cb, user_data);
+    i2c_async_add_msg(txn, data, len, I2C_MSG_READ | I2C_MSG_STOP);
+    return i2c_async_submit(txn);
+}
+
+int i2c_write_async(struct i2c_async_txn *txn, const struct device *i2c_dev, uint8_t dev_addr,
+                    const uint8_t *data, size_t len, i2c_async_cb_t cb, void *user_data)
+{
+    i2c_async_prep(txn, i2c_dev, dev_addr, cb, user_data);
+    i2c_async_add_msg(txn, (uint8_t *)data, len, I2C_MSG_WRITE | I2C_MSG_STOP);
+    return i2c_async_submit(txn);
+}
+
+int d_i2c_write_to_reg_async(struct i2c_async_txn *txn, const struct i2c_dt_spec *spec,
+                             uint8_t address, uint8_t data, i2c_async_cb_t cb, void *user_data)
+{
+    return i2c_write_register_async(txn, spec->bus, spec->addr, address, data, cb, user_data);
+}
+
+int d_i2c_read_registers_async(struct i2c_async_txn *txn, const struct i2c_dt_spec *spec,
+                               uint8_t reg_addr, uint8_t *data, size_t len,
+                               i2c_async_cb_t cb, void *user_data)
+{
+    return i2c_read_registers_async(txn, spec->bus, spec->addr, reg_addr, data, len, cb, user_data);
+}
+
+//---------------------------------------------------------
+// Blocking wrappers: submit and wait for the completion callback
+//---------------------------------------------------------
+
+// time a blocking caller waits past the device deadline before dropping its transaction
+#define I2C_SYNC_TIMEOUT_MS 100
+
+struct i2c_sync_ctx {
+    struct k_sem done;
+    int result;
+};
+
+static void i2c_sync_cb(int result, void *user_data)
+{
+    struct i2c_sync_ctx *ctx = user_data;
+
+    ctx->result = result;
+    k_sem_give(&ctx->done);
+}
+
+/*
+ * @brief Take a transaction off its bus queue if it has not started yet
+ * @return true if it was removed
+ */
+static bool i2c_async_cancel(struct i2c_async_txn *txn)
+{
+    struct i2c_async_bus *bus = i2c_async_find_bus(txn->bus);
+    k_spinlock_key_t key = k_spin_lock(&bus->lock);
+    bool removed = sys_slist_find_and_remove(&bus->queue, &txn->node);
+    k_spin_unlock(&bus->lock, key);
+
+    if (removed) {
+        key = k_spin_lock(&i2c_stats_lock);
+        txn->client->stats.timeouts++;
+        k_spin_unlock(&i2c_stats_lock, key);
+    }
+    return removed;
+}
+
+static int i2c_sync_wait(struct i2c_sync_ctx *ctx, struct i2c_async_txn *txn, int submit_ret)
+{
+    if (submit_ret < 0) {
+        return submit_ret;
+    }
+    if (k_sem_take(&ctx->done, K_MSEC(txn->client->deadline_ms + I2C_SYNC_TIMEOUT_MS)) == 0) {
+        return ctx->result;
+    }
+    if (i2c_async_cancel(txn)) {
+        return -ETIMEDOUT;
+    }
+    // already on the wire: the driver owns txn and the buffers until it completes
+    k_sem_take(&ctx->done, K_FOREVER);
+    return ctx->result;
+}
+
+#define I2C_SYNC_CTX(name) \
+    struct i2c_sync_ctx name; \
+    k_sem_init(&name.done, 0, 1)
+
+int i2c_write_register(const struct device *i2c_dev,
+                       uint8_t dev_addr, uint8_t reg_addr, uint8_t data)
+{
+    struct i2c_async_txn txn;
+    I2C_SYNC_CTX(ctx);
+    return i2c_sync_wait(&ctx, &txn, i2c_write_register_async(&txn, i2c_dev, dev_addr, reg_addr,
+                                                              data, i2c_sync_cb, &ctx));
+}
+
+int i2c_read_register(const struct device *i2c_dev,
+                      uint8_t dev_addr, uint8_t reg_addr, uint8_t *data)
+{
+    return i2c_read_registers(i2c_dev, dev_addr, reg_addr, data, 1);
+}
+
+int i2c_read_registers(const struct device *i2c_dev,
+                       uint8_t dev_addr, uint8_t reg_addr,
+                       uint8_t *data, size_t len)
+{
+    struct i2c_async_txn txn;
+    I2C_SYNC_CTX(ctx);
+    return i2c_sync_wait(&ctx, &txn, i2c_read_registers_async(&txn, i2c_dev, dev_addr, reg_addr,
+                                                              data, len, i2c_sync_cb, &ctx));
+}
+
+
 bool d_i2c_is_ready(const struct i2c_dt_spec *i2c_dev) {
     if (!i2c_is_ready_dt(i2c_dev)){
         printk("I2C bus is not ready\n");
@@ -101,9 +526,7 @@ bool d_i2c_is_ready(const struct i2c_dt_spec *i2c_dev) {
 bool d_i2c_write_to_reg(const struct i2c_dt_spec *spec,
                         uint8_t address, uint8_t data)
 {
-    lock_if_i2c0_dt(spec);
-    int ret = i2c_reg_write_byte_dt(spec, address, data);
-    unlock_if_i2c0_dt(spec);
+    int ret = i2c_write_register(spec->bus, spec->addr, address, data);
 
     if (ret < 0) {
         printk("Failed to write byte %x to register %x\n", data, address);
@@ -116,23 +539,13 @@ bool d_i2c_write_to_reg(const struct i2c_dt_spec *spec,
 bool d_i2c_read_register(const struct i2c_dt_spec *spec,
                          uint8_t reg_addr, uint8_t *data)
 {
-    lock_if_i2c0_dt(spec);
-    int ret = i2c_write_read_dt(spec, &reg_addr, 1, data, 1);
-    unlock_if_i2c0_dt(spec);
-
-    if (ret < 0) {
-        return false;
-    }
-    if (REPORT_SUCCESS) printk("Read register %x\n", reg_addr);
-    return true;
+    return d_i2c_read_registers(spec, reg_addr, data, 1);
 }
 
 bool d_i2c_read_registers(const struct i2c_dt_spec *spec,
                           uint8_t reg_addr, uint8_t *data, size_t len)
 {
-    lock_if_i2c0_dt(spec);
-    int ret = i2c_write_read_dt(spec, &reg_addr, 1, data, len);
-    unlock_if_i2c0_dt(spec);
+    int ret = i2c_read_registers(spec->bus, spec->addr, reg_addr, data, len);
 
     if (ret < 0) {
         return false;
@@ -142,9 +555,10 @@ bool d_i2c_read_registers(const struct i2c_dt_spec *spec,
 }
 
 bool d_i2c_read(const struct i2c_dt_spec *spec, uint8_t *data, size_t len) {
-    lock_if_i2c0_dt(spec);
-    int ret = i2c_read_dt(spec, data, len);
-    unlock_if_i2c0_dt(spec);
+    struct i2c_async_txn txn;
+    I2C_SYNC_CTX(ctx);
+    int ret = i2c_sync_wait(&ctx, &txn, i2c_read_async(&txn, spec->bus, spec->addr, data, len,
+                                                       i2c_sync_cb, &ctx));
     if (ret < 0) {
         printk("Failed to read %d bytes\n", len);
         return false;
@@ -155,9 +569,10 @@ bool d_i2c_read(const struct i2c_dt_spec *spec, uint8_t *data, size_t len) {
 }
 
 bool d_i2c_write(const struct i2c_dt_spec *spec, const uint8_t *data, size_t len) {
-    lock_if_i2c0_dt(spec);
-    int ret = i2c_write_dt(spec, data, len);
-    unlock_if_i2c0_dt(spec);
+    struct i2c_async_txn txn;
+    I2C_SYNC_CTX(ctx);
+    int ret = i2c_sync_wait(&ctx, &txn, i2c_write_async(&txn, spec->bus, spec->addr, data, len,
+                                                        i2c_sync_cb, &ctx));
     if (ret < 0) {
         printk("Failed to write %d bytes\n", len);
         return false;
@@ -166,4 +581,3 @@ bool d_i2c_write(const struct i2c_dt_spec *spec, const uint8_t *data, size_t len
         return true;
     }
 }
-    
\ No newline at end of file
@@ -6,17 +6,79 @@
 #include <stddef.h>
 
 #include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
 #include <zephyr/sys/printk.h>
 #include <zephyr/drivers/i2c.h>
 
 #define REPORT_SUCCESS false
 
-// General I2C read/write functions
+#define REPORT_I2C_STATS false
+
+// Sensor buses; the macros are also usable in static initializers
+#define I2C_BUS0 DEVICE_DT_GET(DT_NODELABEL(i2c0))
+#define I2C_BUS1 DEVICE_DT_GET(DT_NODELABEL(i2c1))
+extern const struct device *i2c_dev0;
+extern const struct device *i2c_dev1;
+
+typedef void (*i2c_async_cb_t)(int result, void *user_data);
+
+struct i2c_client_stats {
+    uint32_t transactions;
+    uint32_t errors;
+    uint32_t missed_deadlines;   // completed later than deadline_ms after submit
+    uint32_t timeouts;           // dropped from the queue by a blocking caller that gave up
+    uint32_t latency_max_us;
+    uint64_t latency_total_us;
+};
+
+// Time a bus spent transferring, from the start of a transaction to its completion
+struct i2c_bus_stats {
+    uint32_t transactions;
+    uint64_t busy_us;
+};
+
+// Bus scheduling parameters of one device
+struct i2c_client {
+    const char *name;
+    uint16_t addr;
+    uint8_t priority;            // lower value is served first
+    uint32_t deadline_ms;        // submit-to-completion budget
+    struct i2c_client_stats stats;
+};
+
+// One queued bus transaction; owned by the caller until its callback has run
+struct i2c_async_txn {
+    sys_snode_t node;
+    const struct device *bus;
+    uint16_t addr;
+    uint8_t wbuf[2];
+    struct i2c_msg msgs[2];
+    uint8_t num_msgs;
+    i2c_async_cb_t cb;
+    void *user_data;
+    struct i2c_client *client;
+    uint32_t submit_cycles;
+    uint32_t deadline_cycles;
+};
+
+// Asynchronous submit functions: return immediately, cb(result, user_data) runs on
+// completion, possibly in interrupt context. cb may be NULL for fire-and-forget writes.
+int i2c_async_submit(struct i2c_async_txn *txn);
+int i2c_write_register_async(struct i2c_async_txn *txn, const struct device *i2c_dev, uint8_t dev_addr, uint8_t reg_addr, uint8_t data, i2c_async_cb_t cb, void *user_data);
+int i2c_read_registers_async(struct i2c_async_txn *txn, const struct device *i2c_dev, uint8_t dev_addr, uint8_t reg_addr, uint8_t *data, size_t len, i2c_async_cb_t cb, void *user_data);
+int i2c_read_async(struct i2c_async_txn *txn, const struct device *i2c_dev, uint8_t dev_addr, uint8_t *data, size_t len, i2c_async_cb_t cb, void *user_data);
+int i2c_write_async(struct i2c_async_txn *txn, const struct device *i2c_dev, uint8_t dev_addr, const uint8_t *data, size_t len, i2c_async_cb_t cb, void *user_data);
+int d_i2c_write_to_reg_async(struct i2c_async_txn *txn, const struct i2c_dt_spec *spec, uint8_t address, uint8_t data, i2c_async_cb_t cb, void *user_data);
+int d_i2c_read_registers_async(struct i2c_async_txn *txn, const struct i2c_dt_spec *spec, uint8_t reg_addr, uint8_t *data, size_t len, i2c_async_cb_t cb, void *user_data);
+
+// General I2C read/write functions (blocking: submit and wait)
 int i2c_write_register(const struct device *i2c_dev, uint8_t dev_addr, uint8_t reg_addr, uint8_t data);
 int i2c_read_register(const struct device *i2c_dev, uint8_t dev_addr, uint8_t reg_addr, uint8_t *data);
 int i2c_read_registers(const struct device *i2c_dev, uint8_t dev_addr, uint8_t reg_addr, uint8_t *data, size_t len);
-void i2c_init(void);
-void i2c_read_data(void);
+int i2c_client_stats_get(const char *name, struct i2c_client_stats *out);
+int i2c_bus_stats_get(const struct device *i2c_dev, struct i2c_bus_stats *out);
+uint64_t i2c_overlap_us_get(void);
+void i2c_print_stats(void);
 
 bool d_i2c_is_ready(const struct i2c_dt_spec *i2c_dev);
 bool d_i2c_write_to_reg(const struct i2c_dt_spec *i2c_dev, uint8_t address, uint8_t data);
@@ -0,0 +1,76 @@
+#include <string.h>
+
+#include "imu_events.h"
+
+uint32_t imu_isqrt(uint32_t v)
+{
+    uint32_t res = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (v >= res + bit) {
+            v -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return res;
+}
+
+uint32_t imu_norm(const int16_t v[3], uint32_t hint)
+{
+    // 3 * 32768^2 still fits in 32 bits
+    uint32_t sq = (uint32_t)((int32_t)v[0] * v[0]) +
+                  (uint32_t)((int32_t)v[1] * v[1]) +
+                  (uint32_t)((int32_t)v[2] * v[2]);
+
+    if (hint == 0 || sq == 0) {
+        return imu_isqrt(sq);
+    }
+
+    // one step from any positive start lands at or above floor(sqrt), then decreases to it
+    uint32_t x = (hint + sq / hint) / 2;
+    uint32_t y = (x + sq / x) / 2;
+    while (y < x) {
+        x = y;
+        y = (x + sq / x) / 2;
+    }
+    return x;
+}
+
+void imu_detector_init(imu_detector_t *d, uint32_t threshold, uint32_t debounce_ms, uint16_t lag)
+{
+    memset(d, 0, sizeof(*d));
+    d->threshold = threshold;
+    d->debounce_ms = debounce_ms;
+    d->lag = lag < 1 ? 1 : lag > IMU_DETECTOR_MAX_LAG ? IMU_DETECTOR_MAX_LAG : lag;
+}
+
+bool imu_detector_update(imu_detector_t *d, const int16_t v[3], uint32_t now)
+{
+    uint32_t mag = imu_norm(v, d->prev_mag);
+    uint32_t old = d->history[d->head];
+    bool event = false;
+
+    d->history[d->head] = mag;
+    d->head = (d->head + 1) % d->lag;
+    d->prev_mag = mag;
+
+    // no reference magnitude until the history has filled once
+    if (d->primed < d->lag) {
+        d->primed++;
+        return false;
+    }
+
+    uint32_t delta = mag > old ? mag - old : old - mag;
+    if (delta > d->threshold && now - d->last_event > d->debounce_ms) {
+        d->last_event = now;
+        event = true;
+    }
+    return event;
+}
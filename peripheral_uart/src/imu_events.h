@@ -0,0 +1,64 @@
+#ifndef IMU_EVENTS_H
+#define IMU_EVENTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Integer step and rotation detection on raw MPU6050 samples, shared by the
+ * firmware (MPU6050.c) and the host tools. Plain C only.
+ *
+ * An event is a change of the vector magnitude over `lag` samples larger
+ * than a threshold, at least debounce_ms after the previous event. The lag
+ * keeps the thresholds, tuned on 10 Hz polling, independent of the sample
+ * rate. Magnitudes are integer square roots of the raw LSB sum of squares,
+ * so thresholds are given in raw LSB and no float math runs per sample.
+ */
+
+// MPU6050 full scale settings used by mpu6050_init()
+#define IMU_ACCEL_LSB_PER_G   16384     // +-2 g
+#define IMU_GYRO_LSB_PER_DPS  131       // +-250 deg/s
+
+// physical threshold to raw LSB, rounded at compile time
+#define IMU_ACCEL_G_TO_LSB(g)      ((uint32_t)((g) * IMU_ACCEL_LSB_PER_G + 0.5))
+#define IMU_GYRO_DPS_TO_LSB(dps)   ((uint32_t)((dps) * IMU_GYRO_LSB_PER_DPS + 0.5))
+
+#define IMU_DETECTOR_MAX_LAG 100     // 100 ms at 1 kHz
+
+typedef struct {
+    uint32_t threshold;         // raw LSB
+    uint32_t debounce_ms;
+    uint32_t last_event;
+    uint32_t prev_mag;          // seeds the next square root
+    uint16_t lag;
+    uint16_t head;
+    uint16_t primed;            // samples seen, up to lag
+    uint16_t history[IMU_DETECTOR_MAX_LAG];
+} imu_detector_t;
+
+/**
+ * @brief floor(sqrt(v))
+ */
+uint32_t imu_isqrt(uint32_t v);
+
+/**
+ * @brief Magnitude of a raw three axis sample in LSB, floor rounded.
+ *
+ * @param hint  A nearby magnitude, e.g. the previous one, or 0. Newton's
+ *              method from a close hint converges in one or two divisions.
+ */
+uint32_t imu_norm(const int16_t v[3], uint32_t hint);
+
+/**
+ * @param lag  Samples between the magnitudes compared, 1..IMU_DETECTOR_MAX_LAG
+ */
+void imu_detector_init(imu_detector_t *d, uint32_t threshold, uint32_t debounce_ms, uint16_t lag);
+
+/**
+ * @brief Feed one raw sample.
+ *
+ * @return true if it is an event
+ */
+bool imu_detector_update(imu_detector_t *d, const int16_t v[3], uint32_t now);
+
+#endif // IMU_EVENTS_H
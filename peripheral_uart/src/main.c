@@ -13,6 +13,15 @@
 #include "heart_rate.h"
 #include "aggregator.h"
 #include "i2c.h"
+#include "ble_link.h"
+#include "ble_tx.h"
+#include "waveform.h"
+#include "health_services.h"
+#include "flash_log.h"
+#include "motion_filter.h"
+#include "ppg_dsp.h"
+#include "sensor_registry.h"
+#include "timestamp.h"
 
 //------------bluetooth---------------
 
@@ -31,14 +40,15 @@
 #include <zephyr/bluetooth/gatt.h>
 #include <zephyr/bluetooth/services/bas.h>
 
-static const struct i2c_dt_spec dev_max30102 = MAX30102_DT_SPEC;
-
-// Global buffer to store the current message
-static char gatt_string_msg[1024] = "Hello, World!";
+// Last telemetry frame sent, also returned on read
+static uint8_t telemetry_frame[TELEMETRY_MAX_FRAME_SIZE];
+static uint16_t telemetry_frame_len;
 
 static const struct bt_data ad[] = {
 	BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
 	BT_DATA_BYTES(BT_DATA_UUID16_ALL,
+		      BT_UUID_16_ENCODE(BT_UUID_HRS_VAL),
+		      BT_UUID_16_ENCODE(BT_UUID_POS_VAL),
 		      BT_UUID_16_ENCODE(BT_UUID_HTS_VAL),
 		      BT_UUID_16_ENCODE(BT_UUID_DIS_VAL),
 		      BT_UUID_16_ENCODE(BT_UUID_BAS_VAL)),
@@ -54,7 +64,7 @@ static ssize_t read_gatt_string(struct bt_conn *conn,
 	const struct bt_gatt_attr *attr,
 	void *buf, uint16_t len, uint16_t offset)
 {
-	return bt_gatt_attr_read(conn, attr, buf, len, offset, gatt_string_msg, strlen(gatt_string_msg));
+	return bt_gatt_attr_read(conn, attr, buf, len, offset, telemetry_frame, telemetry_frame_len);
 }
 
 static ssize_t write_gatt_string(struct bt_conn *conn, 
@@ -84,7 +94,7 @@ BT_GATT_SERVICE_DEFINE(gatt_service,
     BT_GATT_CHARACTERISTIC(BT_UUID_GATT_STRING,
                            BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE | BT_GATT_CHRC_NOTIFY, 
                            BT_GATT_PERM_READ | BT_GATT_PERM_WRITE,
-                           read_gatt_string, write_gatt_string, gatt_string_msg),
+                           read_gatt_string, write_gatt_string, telemetry_frame),
 	BT_GATT_CCC(notify_subscribe_cb, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE)
 );
 
@@ -180,6 +190,7 @@ void button_changed(uint32_t button_state, uint32_t has_changed)
 	if(buttons == 1){
 		
 		collect_data = !collect_data;
+		sensor_registry_set_paused(!collect_data);
 		error_led(!collect_data);
 		if(collect_data){
 			printf("Collecting Data\n");
@@ -208,16 +219,19 @@ static void configure_gpio(void)
 	} 
 }
 
-void send_message_to_bluetooth(const char *msg)
+void send_frame_to_bluetooth(const uint8_t *data, uint16_t len)
 {
-	// Safely copy the message to the global buffer
-	strncpy(gatt_string_msg, msg, sizeof(gatt_string_msg) - 1);
-	gatt_string_msg[sizeof(gatt_string_msg) - 1] = '\0'; // ensure null-termination
-
-	// Notify the client (if notifications are supported and enabled)
-	bt_gatt_notify(NULL, &gatt_service.attrs[1], gatt_string_msg, strlen(gatt_string_msg));
+	if (len > sizeof(telemetry_frame)) {
+		len = sizeof(telemetry_frame);
+	}
+	memcpy(telemetry_frame, data, len);
+	telemetry_frame_len = len;
 
-	// printk("%s\n", gatt_string_msg);
+	// Queued for notification, fragmented if it exceeds the current MTU;
+	// kept in the flash log for a later backfill while nobody is listening
+	if (ble_tx_send(&gatt_service.attrs[1], telemetry_frame, telemetry_frame_len) == -ENOTCONN) {
+		flash_log_append(telemetry_frame, telemetry_frame_len);
+	}
 }
 
 void configure_leds(void)
@@ -255,11 +269,13 @@ int main(void)
 	// printk("UUID (16-bit): 0x%04X\n", BT_UUID_GATT_STRING_VAL);
 	//------------bluetooth---------------
 	int64_t last_send = k_uptime_get();
+	int64_t last_stats = last_send;
 	//----------------------
-	/* Verify ADC readiness */
-    adc_init();
-	i2c_init();
-	max30102_default_setup(&dev_max30102);
+	// Readings accumulate across the whole 1 s reporting interval
+	aggregator_init();
+	flash_log_init();
+	// Every registered sensor is initialized and then read on its own period
+	sensor_registry_start();
 	//-------------------------
     // Main loop to blink LED to indicate status
     while(1) {
@@ -267,23 +283,31 @@ int main(void)
 	
 		dk_set_led(RUN_STATUS_LED, (++blink_status) % 2);
 
-		aggregator_init();
-
-		if(collect_data){
-			i2c_read_data();
-			get_adc_data();
-			if (!d_i2c_is_ready(&dev_max30102)) {
-				printk("MAX30102 not ready\n");
-			} else {
-				max30102_read_data_spo2(&dev_max30102);
-    		}
-		}
-
 		int64_t now = k_uptime_get();
         if (now - last_send >= 1000) {
             aggregator_finalize_and_send();
             last_send = now;
         }
+
+        if ((REPORT_I2C_STATS || REPORT_BLE_STATS || REPORT_MOTION_STATS || REPORT_IMU_STATS ||
+             REPORT_SENSOR_STATS || REPORT_PPG_DSP_STATS || REPORT_TIMESTAMP_STATS ||
+             REPORT_ADC_STATS || REPORT_MAX30102_STATS) &&
+            now - last_stats >= 10000) {
+            if (REPORT_SENSOR_STATS) sensor_registry_print_stats();
+            if (REPORT_TIMESTAMP_STATS) timestamp_print_stats();
+            if (REPORT_ADC_STATS) adc_print_stats();
+            if (REPORT_MAX30102_STATS) max30102_print_stats();
+            if (REPORT_PPG_DSP_STATS) ppg_dsp_print_stats();
+            if (REPORT_I2C_STATS) i2c_print_stats();
+            if (REPORT_IMU_STATS) mpu6050_print_stats();
+            if (REPORT_MOTION_STATS) motion_filter_print_stats();
+            if (REPORT_BLE_STATS) {
+                ble_link_print_stats();
+                ble_tx_print_stats();
+                waveform_print_stats();
+            }
+            last_stats = now;
+        }
 		
         k_sleep(K_MSEC(100));
     }
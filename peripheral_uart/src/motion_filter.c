@@ -0,0 +1,175 @@
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+#include "motion_filter.h"
+#include "nlms.h"
+#include "spo2_algorithm.h"
+#include "spsc_ring.h"
+
+#define ACCEL_HISTORY     256   // > 2.5 s at 100 Hz, covers the PPG FIFO backlog and DSP queue
+#define PPG_PERIOD_MS     (1000 / FreqS)
+#define DC_SHIFT          5     // ~1.3 s time constant at 25 sps
+#define MOTION_LSB        800   // ~0.05 g of non-gravity acceleration
+#define MOTION_HOLD_MS    2000
+
+struct accel_sample {
+    uint32_t timestamp;
+    int16_t  accel[3];
+};
+
+// written by the MPU6050 acquisition, read in place and consumed by the PPG processing
+SPSC_RING_DEFINE(accel_ring, struct accel_sample, ACCEL_HISTORY);
+
+static struct motion_filter_stats stats;
+static uint32_t moving_until;
+static bool moving;
+
+void motion_filter_add_accel(uint32_t timestamp_ms, const int16_t accel[3])
+{
+    struct accel_sample *s;
+
+    // full only while no PPG is processed; the newest samples are the ones dropped
+    if (spsc_ring_write_span(&accel_ring, (void **)&s) == 0) {
+        return;
+    }
+    s->timestamp = timestamp_ms;
+    memcpy(s->accel, accel, sizeof(s->accel));
+    spsc_ring_commit(&accel_ring, 1);
+}
+
+static int32_t accel_dc[3];             // << DC_SHIFT
+static int32_t accel_mean[3];           // last decimated sample, held while none is newer
+static bool initialized;
+
+#ifdef CONFIG_PPG_MOTION_FILTER
+#define REF_EPS           ((int64_t)3 * CONFIG_PPG_MOTION_FILTER_ORDER * 256 * 256)
+
+BUILD_ASSERT(3 * CONFIG_PPG_MOTION_FILTER_ORDER <= NLMS_MAX_TAPS,
+             "PPG motion filter order too large");
+
+static nlms_t ir_filter, red_filter;
+static int32_t ir_dc, red_dc;           // << DC_SHIFT
+
+static uint32_t cancel(nlms_t *f, int32_t *dc, uint32_t x, const int16_t *ref)
+{
+    *dc += (int32_t)x - (*dc >> DC_SHIFT);
+    int32_t level = *dc >> DC_SHIFT;
+    int32_t clean = level + nlms_update(f, ref, (int32_t)x - level);
+
+    return clean > 0 ? clean : 0;
+}
+#endif
+
+/*
+ * @brief Box-car decimate the accelerometer over the PPG sample period
+ *        ending at @p timestamp; keeps the previous value if none is stored.
+ */
+static void decimate_accel(uint32_t timestamp)
+{
+    int32_t sum[3] = { 0 };
+    uint32_t available = spsc_ring_count(&accel_ring);
+    uint32_t old = 0, n = 0;
+
+    // PPG timestamps only move forward, so samples older than the period are done with
+    while (old < available) {
+        const struct accel_sample *s = spsc_ring_peek(&accel_ring, old);
+
+        if ((int32_t)(timestamp - s->timestamp) < PPG_PERIOD_MS) {
+            break;
+        }
+        old++;
+    }
+    spsc_ring_consume(&accel_ring, old);
+
+    // oldest first, samples newer than the PPG sample stay for the next one
+    for (uint32_t i = 0; i < available - old; i++) {
+        const struct accel_sample *s = spsc_ring_peek(&accel_ring, i);
+
+        if ((int32_t)(timestamp - s->timestamp) < 0) {
+            break;
+        }
+        for (int c = 0; c < 3; c++) {
+            sum[c] += s->accel[c];
+        }
+        n++;
+    }
+
+    if (n > 0) {
+        for (int c = 0; c < 3; c++) {
+            accel_mean[c] = sum[c] / (int32_t)n;
+        }
+    }
+}
+
+/*
+ * @brief Reference sample for @p timestamp: decimated acceleration with
+ *        gravity and sensor offset removed by the same DC tracker as the PPG
+ */
+static void update_reference(uint32_t timestamp, int16_t ref[3])
+{
+    decimate_accel(timestamp);
+
+    for (int c = 0; c < 3; c++) {
+        if (!initialized) {
+            accel_dc[c] = accel_mean[c] << DC_SHIFT;
+        }
+        accel_dc[c] += accel_mean[c] - (accel_dc[c] >> DC_SHIFT);
+        int32_t v = accel_mean[c] - (accel_dc[c] >> DC_SHIFT);
+
+        ref[c] = CLAMP(v, INT16_MIN, INT16_MAX);
+        if (abs(v) > MOTION_LSB) {
+            moving_until = timestamp + MOTION_HOLD_MS;
+        }
+    }
+    moving = (int32_t)(moving_until - timestamp) > 0;
+}
+
+void motion_filter_process(uint32_t timestamp_ms, uint32_t *ir, uint32_t *red)
+{
+    uint32_t start = k_cycle_get_32();
+    int16_t ref[3];
+
+    update_reference(timestamp_ms, ref);
+
+#ifdef CONFIG_PPG_MOTION_FILTER
+    if (!initialized) {
+        nlms_init(&ir_filter, 3, CONFIG_PPG_MOTION_FILTER_ORDER, CONFIG_PPG_MOTION_FILTER_MU_SHIFT, REF_EPS);
+        nlms_init(&red_filter, 3, CONFIG_PPG_MOTION_FILTER_ORDER, CONFIG_PPG_MOTION_FILTER_MU_SHIFT, REF_EPS);
+        ir_dc = *ir << DC_SHIFT;
+        red_dc = *red << DC_SHIFT;
+    }
+    *ir = cancel(&ir_filter, &ir_dc, *ir, ref);
+    *red = cancel(&red_filter, &red_dc, *red, ref);
+#endif
+    initialized = true;
+
+    stats.filter_cycles += k_cycle_get_32() - start;
+    stats.samples++;
+}
+
+void motion_filter_account_result(bool valid)
+{
+    stats.results++;
+    stats.valid += valid;
+    if (moving) {
+        stats.moving_results++;
+        stats.moving_valid += valid;
+    }
+}
+
+void motion_filter_get_stats(struct motion_filter_stats *out)
+{
+    *out = stats;
+}
+
+void motion_filter_print_stats(void)
+{
+    if (stats.samples == 0) {
+        return;
+    }
+    printk("Motion filter: %u samples, %u cycles/sample, valid %u/%u, moving %u/%u\n",
+           stats.samples, (uint32_t)(stats.filter_cycles / stats.samples),
+           stats.valid, stats.results, stats.moving_valid, stats.moving_results);
+}
@@ -0,0 +1,50 @@
+#ifndef MOTION_FILTER_H
+#define MOTION_FILTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * PPG motion artifact cancellation: the MPU6050 accelerometer, decimated to
+ * the PPG sample rate with gravity removed, is the noise reference of one
+ * NLMS canceller per PPG channel. Cleaned samples keep their DC level, so the
+ * SpO2 AC/DC ratio is unchanged while at rest.
+ */
+
+// Set to true to print filter cost and SpO2/HR yield with the other stats
+#define REPORT_MOTION_STATS false
+
+struct motion_filter_stats {
+    uint32_t samples;
+    uint64_t filter_cycles;
+    uint32_t results;           // SpO2/HR results published
+    uint32_t valid;             // ... with both SpO2 and HR valid
+    uint32_t moving_results;    // published while the wearer was moving
+    uint32_t moving_valid;
+};
+
+/**
+ * @brief Record one accelerometer sample (raw LSB) as reference.
+ */
+void motion_filter_add_accel(uint32_t timestamp_ms, const int16_t accel[3]);
+
+/**
+ * @brief Remove the accelerometer-correlated component from one PPG sample.
+ *        Pass-through when CONFIG_PPG_MOTION_FILTER is disabled, which still
+ *        tracks motion for the yield statistics.
+ *
+ * @param timestamp_ms  Uptime at which the PPG sample was taken
+ * @param ir            IR sample, replaced by the cleaned value
+ * @param red           Red sample, replaced by the cleaned value
+ */
+void motion_filter_process(uint32_t timestamp_ms, uint32_t *ir, uint32_t *red);
+
+/**
+ * @brief Count a published SpO2/HR result towards the yield statistics.
+ */
+void motion_filter_account_result(bool valid);
+
+void motion_filter_get_stats(struct motion_filter_stats *out);
+void motion_filter_print_stats(void);
+
+#endif // MOTION_FILTER_H
@@ -0,0 +1,50 @@
+#include <string.h>
+
+#include "nlms.h"
+
+int nlms_init(nlms_t *f, int channels, int order, int mu_shift, int64_t eps)
+{
+    if (channels < 1 || order < 1 || channels * order > NLMS_MAX_TAPS) {
+        return -1;
+    }
+    memset(f, 0, sizeof(*f));
+    f->channels = channels;
+    f->order = order;
+    f->mu_shift = mu_shift;
+    f->eps = eps > 0 ? eps : 1;
+    return 0;
+}
+
+int32_t nlms_update(nlms_t *f, const int16_t *ref, int32_t x)
+{
+    int taps = f->channels * f->order;
+    int64_t acc = 0;
+    int64_t power = f->eps;
+
+    for (int c = 0; c < f->channels; c++) {
+        int16_t *r = &f->r[c * f->order];
+        memmove(&r[1], &r[0], (f->order - 1) * sizeof(r[0]));
+        r[0] = ref[c];
+    }
+
+    for (int i = 0; i < taps; i++) {
+        acc += (int64_t)f->w[i] * f->r[i];
+        power += (int32_t)f->r[i] * f->r[i];
+    }
+
+    int32_t e = x - (int32_t)(acc >> NLMS_WEIGHT_FRAC);
+
+    // Q16 step per unit of reference, one division per sample
+    int64_t g = (((int64_t)e << NLMS_WEIGHT_FRAC) / power) >> f->mu_shift;
+    if (g == 0) {
+        return e;
+    }
+
+    for (int i = 0; i < taps; i++) {
+        int64_t w = f->w[i] + g * f->r[i];
+        if (w > NLMS_WEIGHT_MAX) w = NLMS_WEIGHT_MAX;
+        if (w < -NLMS_WEIGHT_MAX) w = -NLMS_WEIGHT_MAX;
+        f->w[i] = (int32_t)w;
+    }
+    return e;
+}
@@ -0,0 +1,50 @@
+#ifndef NLMS_H
+#define NLMS_H
+
+#include <stdint.h>
+
+/*
+ * Fixed-point normalized LMS adaptive noise canceller, shared by the firmware
+ * (motion_filter.c) and the host tools. Plain C only.
+ *
+ * The filter predicts the part of x that is linearly related to the last
+ * `order` samples of each reference channel and returns the error
+ * e = x - w.r, i.e. x with that part removed. Weights adapt by
+ *   w += mu * e * r / (eps + |r|^2),  mu = 2^-mu_shift
+ * and are kept in Q16.
+ *
+ * x should be zero mean and within +-2^20, references within int16.
+ */
+#define NLMS_MAX_TAPS    16
+#define NLMS_WEIGHT_FRAC 16
+#define NLMS_WEIGHT_MAX  (1 << 30)
+
+typedef struct {
+    int     channels;
+    int     order;
+    int     mu_shift;
+    int64_t eps;
+    int32_t w[NLMS_MAX_TAPS];       // Q16, [channel][order]
+    int16_t r[NLMS_MAX_TAPS];       // delay line, newest sample first per channel
+} nlms_t;
+
+/**
+ * @brief Reset the weights and delay line.
+ *
+ * @param channels  Reference channels, channels * order <= NLMS_MAX_TAPS
+ * @param order     Taps per reference channel
+ * @param mu_shift  Step size as a power of two
+ * @param eps       Regularization added to the reference power, keeps the
+ *                  step bounded when the references are quiet
+ * @return 0, or -1 if the taps do not fit
+ */
+int nlms_init(nlms_t *f, int channels, int order, int mu_shift, int64_t eps);
+
+/**
+ * @brief Shift one sample of every reference channel in, filter x and adapt.
+ *
+ * @return x minus its estimated reference-correlated component
+ */
+int32_t nlms_update(nlms_t *f, const int16_t *ref, int32_t x);
+
+#endif // NLMS_H
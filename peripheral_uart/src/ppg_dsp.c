@@ -0,0 +1,113 @@
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+#include "ppg_dsp.h"
+#include "spsc_ring.h"
+#include "spo2_stream.h"
+#include "motion_filter.h"
+#include "health_services.h"
+#include "aggregator.h"
+
+// written by the MAX30102 acquisition, processed in place by the work queue
+SPSC_RING_DEFINE(ppg_ring, struct ppg_sample, PPG_DSP_RING_SAMPLES);
+
+static struct ppg_dsp_stats stats;
+
+static K_THREAD_STACK_DEFINE(ppg_dsp_stack, CONFIG_PPG_DSP_STACK_SIZE);
+static struct k_work_q ppg_dsp_q;
+
+static void ppg_dsp_work_handler(struct k_work *work);
+static K_WORK_DEFINE(ppg_dsp_work, ppg_dsp_work_handler);
+
+uint32_t ppg_dsp_space(void)
+{
+    return spsc_ring_space(&ppg_ring);
+}
+
+uint32_t ppg_dsp_write_span(struct ppg_sample **span)
+{
+    return spsc_ring_write_span(&ppg_ring, (void **)span);
+}
+
+void ppg_dsp_drop(uint32_t n)
+{
+    stats.dropped += n;
+}
+
+void ppg_dsp_commit(uint32_t n)
+{
+    spsc_ring_commit(&ppg_ring, n);
+    stats.max_backlog = MAX(stats.max_backlog, spsc_ring_count(&ppg_ring));
+
+    k_work_submit_to_queue(&ppg_dsp_q, &ppg_dsp_work);
+}
+
+/*
+ * @brief Run a span of samples through the motion filter and the streaming
+ *        SpO2/HR engine, publishing every new result
+ */
+static void ppg_dsp_process(const struct ppg_sample *samples, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t ir = samples[i].ir;
+
+        // the finger check below uses the raw IR level
+        uint32_t clean_ir = ir, clean_red = samples[i].red;
+        motion_filter_process(samples[i].timestamp, &clean_ir, &clean_red);
+
+        spo2_stream_result_t result;
+        if (!spo2_stream_add_sample(clean_ir, clean_red, &result)) {
+            continue;
+        }
+
+        int32_t spo2 = (ir < 100000) ? 0 : result.spo2; // checking IR value to see if finger is placed
+
+        motion_filter_account_result(result.spo2_valid && result.heart_rate_valid);
+        health_update_heart_rate(result.heart_rate, result.heart_rate_valid);
+        health_update_spo2(spo2, result.spo2_valid && spo2 != 0, result.heart_rate, result.heart_rate_valid);
+        aggregator_add_int(TELEMETRY_SPO2, spo2);
+    }
+}
+
+static void ppg_dsp_work_handler(struct k_work *work)
+{
+    struct ppg_sample *span;
+    uint32_t count;
+    uint32_t start = k_cycle_get_32();
+
+    // a wrapped ring is drained in two spans
+    while ((count = spsc_ring_read_span(&ppg_ring, (void **)&span)) > 0) {
+        ppg_dsp_process(span, count);
+        spsc_ring_consume(&ppg_ring, count);
+        stats.samples += count;
+    }
+
+    uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+    stats.max_process_us = MAX(stats.max_process_us, us);
+}
+
+void ppg_dsp_get_stats(struct ppg_dsp_stats *out)
+{
+    *out = stats;
+}
+
+void ppg_dsp_print_stats(void)
+{
+    struct ppg_dsp_stats s;
+
+    ppg_dsp_get_stats(&s);
+    printk("PPG DSP: %u samples, %u dropped, backlog max %u/%u, process max %u us\n",
+           s.samples, s.dropped, s.max_backlog, PPG_DSP_RING_SAMPLES, s.max_process_us);
+}
+
+static int ppg_dsp_init(void)
+{
+    const struct k_work_queue_config cfg = { .name = "ppg_dsp" };
+
+    k_work_queue_start(&ppg_dsp_q, ppg_dsp_stack, K_THREAD_STACK_SIZEOF(ppg_dsp_stack),
+                       CONFIG_PPG_DSP_PRIORITY, &cfg);
+    return 0;
+}
+
+SYS_INIT(ppg_dsp_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,58 @@
+#ifndef PPG_DSP_H
+#define PPG_DSP_H
+
+#include <stdint.h>
+
+/*
+ * PPG signal processing stage: motion artifact cancellation, the streaming
+ * SpO2/HR engine and result publishing run on a low-priority work queue.
+ * The MAX30102 acquisition decodes its FIFO straight into a single-producer,
+ * single-consumer ring that the work queue processes in place, so a slow
+ * algorithm pass never delays a FIFO drain.
+ */
+
+// Set to true to print DSP queue and processing statistics with the other stats
+#define REPORT_PPG_DSP_STATS false
+
+#define PPG_DSP_RING_SAMPLES 128    // ~5 s at 25 sps, four full MAX30102 FIFOs
+
+struct ppg_sample {
+    uint32_t timestamp;             // timestamp_to_ms() of the time the sample was taken
+    uint32_t red;
+    uint32_t ir;
+};
+
+struct ppg_dsp_stats {
+    uint32_t samples;
+    uint32_t dropped;               // samples not processed because the ring was full
+    uint32_t max_backlog;           // most samples waiting for processing
+    uint32_t max_process_us;        // longest processing pass
+};
+
+/**
+ * @brief Free slots in the sample ring. Acquisition side only.
+ */
+uint32_t ppg_dsp_space(void);
+
+/**
+ * @brief Contiguous free slots to decode samples into. Acquisition side only.
+ *
+ * @param span  Set to the first free slot
+ * @return Number of slots in the span
+ */
+uint32_t ppg_dsp_write_span(struct ppg_sample **span);
+
+/**
+ * @brief Queue @p n samples written through ppg_dsp_write_span() for processing.
+ */
+void ppg_dsp_commit(uint32_t n);
+
+/**
+ * @brief Count @p n samples the ring had no room for. Acquisition side only.
+ */
+void ppg_dsp_drop(uint32_t n);
+
+void ppg_dsp_get_stats(struct ppg_dsp_stats *out);
+void ppg_dsp_print_stats(void);
+
+#endif // PPG_DSP_H
@@ -0,0 +1,186 @@
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+
+#include "sensor_registry.h"
+#include "i2c.h"
+
+// wake-up interval when no sensor is scheduled
+#define SENSOR_IDLE_MS 1000
+
+/*
+ * One scheduler thread per context; the last one serves sensors off the I2C
+ * buses. A thread is started only if its context has a polled sensor, so a
+ * bus whose sensors are all self-driven (interrupt mode) gets none.
+ */
+struct sensor_context {
+    const char *name;
+    const struct device *bus;
+};
+
+static const struct sensor_context sensor_contexts[] = {
+    { .name = "i2c0",  .bus = I2C_BUS0 },
+    { .name = "i2c1",  .bus = I2C_BUS1 },
+    { .name = "other", .bus = NULL },
+};
+
+#define SENSOR_CONTEXT_COUNT ARRAY_SIZE(sensor_contexts)
+
+static atomic_t paused;
+static K_MUTEX_DEFINE(pause_mutex);
+static K_CONDVAR_DEFINE(resume_condvar);
+
+void sensor_registry_set_paused(bool pause)
+{
+    k_mutex_lock(&pause_mutex, K_FOREVER);
+    atomic_set(&paused, pause);
+    if (!pause) {
+        k_condvar_broadcast(&resume_condvar);
+    }
+    k_mutex_unlock(&pause_mutex);
+}
+
+bool sensor_registry_wait_running(void)
+{
+    bool waited = false;
+
+    if (!atomic_get(&paused)) {
+        return false;
+    }
+    k_mutex_lock(&pause_mutex, K_FOREVER);
+    while (atomic_get(&paused)) {
+        waited = true;
+        k_condvar_wait(&resume_condvar, &pause_mutex, K_FOREVER);
+    }
+    k_mutex_unlock(&pause_mutex);
+    return waited;
+}
+
+/*
+ * @brief Read one sensor if it is due and move its deadline past now,
+ *        in whole periods so it keeps its phase.
+ */
+static void sensor_run_if_due(const struct sensor_desc *s)
+{
+    struct sensor_state *st = s->state;
+    int64_t now = k_uptime_get();
+
+    if (now < st->next_due) {
+        return;
+    }
+
+    uint32_t late = (uint32_t)(now - st->next_due);
+    uint32_t missed = late / s->period_ms;
+
+    if (!atomic_get(&paused)) {
+        uint32_t start = k_cycle_get_32();
+
+        s->read();
+
+        uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+        st->max_read_us = MAX(st->max_read_us, us);
+        st->max_late_ms = MAX(st->max_late_ms, late - missed * s->period_ms);
+        st->reads++;
+    }
+    st->skipped += missed;
+    st->next_due += (int64_t)(missed + 1) * s->period_ms;
+}
+
+static void sensor_scheduler_thread(void *p1, void *p2, void *p3)
+{
+    uint8_t context = (uintptr_t)p1;
+
+    while (1) {
+        int64_t next = k_uptime_get() + SENSOR_IDLE_MS;
+
+        STRUCT_SECTION_FOREACH(sensor_desc, s) {
+            if (!s->state->enabled || s->read == NULL || s->state->context != context) {
+                continue;
+            }
+            sensor_run_if_due(s);
+            next = MIN(next, s->state->next_due);
+        }
+
+        k_sleep(K_TIMEOUT_ABS_MS(next));
+    }
+}
+
+// created suspended, sensor_registry_start() starts the ones with work
+#define SENSOR_SCHEDULER_DEFINE(_n)                                                         \
+    K_THREAD_DEFINE(sensor_scheduler_tid##_n, CONFIG_SENSOR_SCHEDULER_STACK_SIZE,           \
+                    sensor_scheduler_thread, (void *)_n, NULL, NULL,                        \
+                    CONFIG_SENSOR_SCHEDULER_PRIORITY, 0, SYS_FOREVER_MS)
+
+SENSOR_SCHEDULER_DEFINE(0);
+SENSOR_SCHEDULER_DEFINE(1);
+SENSOR_SCHEDULER_DEFINE(2);
+BUILD_ASSERT(SENSOR_CONTEXT_COUNT == 3, "one SENSOR_SCHEDULER_DEFINE() per context");
+
+static uint8_t sensor_find_context(const struct device *bus)
+{
+    for (uint8_t i = 0; i < SENSOR_CONTEXT_COUNT - 1; i++) {
+        if (sensor_contexts[i].bus == bus) {
+            return i;
+        }
+    }
+    return SENSOR_CONTEXT_COUNT - 1;
+}
+
+void sensor_registry_start(void)
+{
+    const k_tid_t schedulers[SENSOR_CONTEXT_COUNT] = {
+        sensor_scheduler_tid0, sensor_scheduler_tid1, sensor_scheduler_tid2,
+    };
+    uint32_t fields = 0;
+    uint32_t polled = 0;        // contexts with a polled sensor
+    int64_t start = k_uptime_get();
+
+    STRUCT_SECTION_FOREACH(sensor_desc, s) {
+        int err = (s->read && s->period_ms == 0) ? -EINVAL : s->init();
+
+        if (err) {
+            printk("Sensor %s disabled (%d)\n", s->name, err);
+            continue;
+        }
+        if (s->fields & fields) {
+            printk("Sensor %s reports fields 0x%08x already reported by another sensor\n",
+                   s->name, s->fields & fields);
+        }
+        fields |= s->fields;
+
+        s->state->enabled = true;
+        s->state->context = sensor_find_context(s->bus);
+        s->state->next_due = start;
+        if (s->read) {
+            polled |= BIT(s->state->context);
+            printk("Sensor %s: every %u ms on %s\n", s->name, s->period_ms,
+                   sensor_contexts[s->state->context].name);
+        } else {
+            printk("Sensor %s: self-driven\n", s->name);
+        }
+    }
+
+    for (size_t i = 0; i < SENSOR_CONTEXT_COUNT; i++) {
+        if (polled & BIT(i)) {
+            k_thread_start(schedulers[i]);
+        } else {
+            printk("Sensor scheduler %s: no polled sensor, not started\n",
+                   sensor_contexts[i].name);
+        }
+    }
+}
+
+void sensor_registry_print_stats(void)
+{
+    STRUCT_SECTION_FOREACH(sensor_desc, s) {
+        const struct sensor_state *st = s->state;
+
+        if (!st->enabled || s->read == NULL) {
+            continue;
+        }
+        printk("Sensor %s (%s): %u reads, %u skipped, late max %u ms, read max %u us\n",
+               s->name, sensor_contexts[st->context].name, st->reads, st->skipped,
+               st->max_late_ms, st->max_read_us);
+    }
+}
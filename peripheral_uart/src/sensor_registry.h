@@ -0,0 +1,96 @@
+#ifndef SENSOR_REGISTRY_H
+#define SENSOR_REGISTRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/iterable_sections.h>
+#include <zephyr/sys/util.h>
+
+#include "telemetry_schema.h"
+
+/*
+ * Every sensor declares itself with SENSOR_DEFINE() in its own source file;
+ * the descriptors are collected in the sensor_desc iterable section. One
+ * scheduler thread per I2C bus, plus one for sensors off the I2C buses,
+ * calls each read function on its own period, keeping the phase of every
+ * sensor so late reads do not drift the schedule. Sensors on different
+ * buses are therefore read concurrently. Only contexts with a polled
+ * sensor get a running thread; self-driven sensors use their own, which
+ * call sensor_registry_wait_running() so that pausing stops both kinds.
+ */
+
+// Set to true to print per-sensor schedule statistics with the other stats
+#define REPORT_SENSOR_STATS false
+
+struct sensor_state {
+    bool     enabled;           // init succeeded
+    uint8_t  context;           // scheduler thread serving the sensor's bus
+    int64_t  next_due;          // uptime (ms) of the next read
+    uint32_t reads;
+    uint32_t skipped;           // whole periods missed because a read ran late
+    uint32_t max_late_ms;       // start jitter of the reads that ran
+    uint32_t max_read_us;
+};
+
+struct sensor_desc {
+    const char *name;
+    const struct device *bus;   // I2C bus the sensor sits on, or NULL
+    int (*init)(void);          // 0 on success, the sensor is not scheduled otherwise
+    void (*read)(void);         // NULL if the sensor drives its own acquisition
+    uint32_t period_ms;
+    uint32_t fields;            // SENSOR_FIELD() of every telemetry field it adds
+    struct sensor_state *state;
+};
+
+#define SENSOR_FIELD(name) BIT(TELEMETRY_##name)
+
+/**
+ * @brief Register a sensor.
+ *
+ * @param _id         C identifier, also the init and schedule order
+ * @param _name       Name used in log output
+ * @param _bus        I2C bus device (I2C_BUS0, I2C_BUS1), or NULL
+ * @param _init       int (*)(void)
+ * @param _read       void (*)(void), or NULL
+ * @param _period_ms  Read period
+ * @param _fields     Telemetry fields the sensor adds, or 0
+ */
+#define SENSOR_DEFINE(_id, _name, _bus, _init, _read, _period_ms, _fields)  \
+    static struct sensor_state _id##_sensor_state;                          \
+    static const STRUCT_SECTION_ITERABLE(sensor_desc, _id##_sensor) = {     \
+        .name = _name,                                                      \
+        .bus = _bus,                                                        \
+        .init = _init,                                                      \
+        .read = _read,                                                      \
+        .period_ms = _period_ms,                                            \
+        .fields = _fields,                                                  \
+        .state = &_id##_sensor_state,                                       \
+    }
+
+/**
+ * @brief Initialize every registered sensor and start the scheduler.
+ */
+void sensor_registry_start(void);
+
+/**
+ * @brief Stop acquisition while paused: polled sensors skip their reads (the
+ *        schedule keeps running), self-driven ones block in
+ *        sensor_registry_wait_running(). Not callable from ISRs.
+ */
+void sensor_registry_set_paused(bool paused);
+
+/**
+ * @brief Block a self-driven acquisition thread while acquisition is paused.
+ *
+ * Called before every read, so no sample reaches the aggregator, the DSP or
+ * the waveform streams while paused.
+ *
+ * @return true if the thread was paused, so whatever the sensor buffered
+ *         meanwhile is stale and should be discarded
+ */
+bool sensor_registry_wait_running(void);
+
+void sensor_registry_print_stats(void);
+
+#endif // SENSOR_REGISTRY_H
@@ -104,6 +104,7 @@ void maxim_heart_rate_and_oxygen_saturation(uint32_t *pun_ir_buffer, int32_t n_i
   int32_t n_x_dc_max_idx = 0; 
   int32_t an_ratio[5], n_ratio_average; 
   int32_t n_nume, n_denom ;
+  int32_t n_ma_sum;
 
   static  int32_t an_x[ BUFFER_SIZE]; //ir
   static  int32_t an_y[ BUFFER_SIZE]; //red
@@ -117,9 +118,11 @@ void maxim_heart_rate_and_oxygen_saturation(uint32_t *pun_ir_buffer, int32_t n_i
   for (k=0 ; k<n_ir_buffer_length ; k++ )  
     an_x[k] = -1*(pun_ir_buffer[k] - un_ir_mean) ; 
     
-  // 4 pt Moving Average
-  for(k=0; k< BUFFER_SIZE-MA4_SIZE; k++){
-    an_x[k]=( an_x[k]+an_x[k+1]+ an_x[k+2]+ an_x[k+3])/(int)4;        
+  // MA_SIZE pt Moving Average
+  for(k=0; k< BUFFER_SIZE-MA_SIZE; k++){
+    n_ma_sum = 0;
+    for (i=0; i<MA_SIZE; i++) n_ma_sum += an_x[k+i];
+    an_x[k]= n_ma_sum/(int)MA_SIZE;
   }
   // calculate threshold  
   n_th1=0; 
@@ -132,7 +135,7 @@ void maxim_heart_rate_and_oxygen_saturation(uint32_t *pun_ir_buffer, int32_t n_i
 
   for ( k=0 ; k<15;k++) an_ir_valley_locs[k]=0;
   // since we flipped signal, we use peak detector as valley detector
-  maxim_find_peaks( an_ir_valley_locs, &n_npks, an_x, BUFFER_SIZE, n_th1, 4, 15 );//peak_height, peak_distance, max_num_peaks 
+  maxim_find_peaks( an_ir_valley_locs, &n_npks, an_x, BUFFER_SIZE, n_th1, PEAK_MIN_DISTANCE, 15 );//peak_height, peak_distance, max_num_peaks 
   n_peak_interval_sum =0;
   if (n_npks>=2){
     for (k=1; k<n_npks; k++) n_peak_interval_sum += (an_ir_valley_locs[k] -an_ir_valley_locs[k -1] ) ;
@@ -172,7 +175,7 @@ void maxim_heart_rate_and_oxygen_saturation(uint32_t *pun_ir_buffer, int32_t n_i
   for (k=0; k< n_exact_ir_valley_locs_count-1; k++){
     n_y_dc_max= -16777216 ; 
     n_x_dc_max= -16777216; 
-    if (an_ir_valley_locs[k+1]-an_ir_valley_locs[k] >3){
+    if (an_ir_valley_locs[k+1]-an_ir_valley_locs[k] >= PEAK_MIN_DISTANCE){
         for (i=an_ir_valley_locs[k]; i< an_ir_valley_locs[k+1]; i++){
           if (an_x[i]> n_x_dc_max) {n_x_dc_max =an_x[i]; n_x_dc_max_idx=i;}
           if (an_y[i]> n_y_dc_max) {n_y_dc_max =an_y[i]; n_y_dc_max_idx=i;}
@@ -69,9 +69,13 @@
 
 #include <zephyr/sys/printk.h>
 
-#define FreqS 25    //sampling frequency
-#define BUFFER_SIZE (FreqS * 4) 
-#define MA4_SIZE 4 // DONOT CHANGE
+#define FreqS CONFIG_SPO2_SAMPLE_RATE    //sampling frequency
+#define BUFFER_SIZE (FreqS * CONFIG_SPO2_WINDOW_SECONDS)
+
+// time constants of the original 25 sps algorithm, converted to samples at FreqS (rounded up)
+#define SPO2_MS_TO_SAMPLES(ms) ((((ms) * FreqS) + 999) / 1000)
+#define MA_SIZE SPO2_MS_TO_SAMPLES(160)           // moving average length, 4 at 25 sps
+#define PEAK_MIN_DISTANCE SPO2_MS_TO_SAMPLES(160) // minimum valley distance, 4 at 25 sps
 //#define min(x,y) ((x) < (y) ? (x) : (y)) //Defined in Arduino.h
 
 //uch_spo2_table is approximated as  -45.060*ratioAverage* ratioAverage + 30.354 *ratioAverage + 94.845 ;
@@ -0,0 +1,282 @@
+#include <string.h>
+
+#include "spo2_stream.h"
+
+/*
+ * Streaming version of maxim_heart_rate_and_oxygen_saturation().
+ *
+ * Instead of recomputing the whole BUFFER_SIZE window on every call, each new
+ * sample updates running sums (IR DC mean, MA_SIZE point moving average, valley
+ * threshold), feeds a streaming valley detector and, when a valley is
+ * confirmed, computes the AC/DC ratio of the beat that just ended. Publishing
+ * a result only touches the valley and ratio lists, so the cost per sample is
+ * O(1) amortized instead of O(BUFFER_SIZE).
+ */
+
+#define SPO2_STREAM_MAX_VALLEYS   15 // same limit as maxim_find_peaks()
+#define SPO2_STREAM_MAX_RATIOS    5
+#define SPO2_STREAM_MIN_TH        30
+#define SPO2_STREAM_MAX_TH        60
+
+typedef struct {
+    // raw samples of the current window, indexed by absolute sample number
+    uint32_t ir[BUFFER_SIZE];
+    uint32_t red[BUFFER_SIZE];
+    uint32_t ir_sum;
+    uint32_t count;              // absolute number of samples received
+
+    // inverted DC-free IR and its moving average
+    int32_t  ma_in[MA_SIZE];
+    int32_t  ma_sum;
+    int32_t  smoothed[BUFFER_SIZE];
+    int32_t  smoothed_sum;
+    uint32_t smoothed_count;     // absolute index of the next smoothed sample
+
+    // valley (inverted peak) detector
+    int32_t  prev_smoothed;
+    bool     in_candidate;
+    uint32_t candidate_idx;
+    int32_t  candidate_val;
+    bool     has_pending;
+    uint32_t pending_idx;
+    int32_t  pending_val;
+
+    uint32_t valleys[SPO2_STREAM_MAX_VALLEYS];
+    int      valley_head;
+    int      valley_count;
+
+    int32_t  ratios[SPO2_STREAM_MAX_RATIOS];
+    uint32_t ratio_idx[SPO2_STREAM_MAX_RATIOS];
+    int      ratio_head;
+    int      ratio_count;
+} spo2_stream_t;
+
+static spo2_stream_t st;
+
+void spo2_stream_reset(void)
+{
+    memset(&st, 0, sizeof(st));
+}
+
+static inline bool in_window(uint32_t idx)
+{
+    return st.count - idx <= BUFFER_SIZE;
+}
+
+/**
+ * @brief Compute the red/IR AC-DC ratio of the beat between two valleys.
+ *
+ * Mirrors the per-beat step of maxim_heart_rate_and_oxygen_saturation(),
+ * including its use of the red maximum index for the IR AC component.
+ */
+static void add_beat_ratio(uint32_t v0, uint32_t v1)
+{
+    int32_t x_dc_max = -16777216, y_dc_max = -16777216;
+    uint32_t y_dc_max_idx = v0;
+
+    if (v1 - v0 < PEAK_MIN_DISTANCE || !in_window(v0)) {
+        return;
+    }
+
+    for (uint32_t i = v0; i < v1; i++) {
+        int32_t x = st.ir[i % BUFFER_SIZE];
+        int32_t y = st.red[i % BUFFER_SIZE];
+        if (x > x_dc_max) { x_dc_max = x; }
+        if (y > y_dc_max) { y_dc_max = y; y_dc_max_idx = i; }
+    }
+
+    int32_t x0 = st.ir[v0 % BUFFER_SIZE],  x1 = st.ir[v1 % BUFFER_SIZE];
+    int32_t y0 = st.red[v0 % BUFFER_SIZE], y1 = st.red[v1 % BUFFER_SIZE];
+    int32_t span = (int32_t)(v1 - v0);
+
+    int32_t y_ac = (y1 - y0) * (int32_t)(y_dc_max_idx - v0);
+    y_ac = y0 + y_ac / span;
+    y_ac = (int32_t)st.red[y_dc_max_idx % BUFFER_SIZE] - y_ac;
+    int32_t x_ac = (x1 - x0) * (int32_t)(y_dc_max_idx - v0);
+    x_ac = x0 + x_ac / span;
+    x_ac = (int32_t)st.ir[y_dc_max_idx % BUFFER_SIZE] - x_ac;
+
+    int64_t nume  = ((int64_t)y_ac * x_dc_max) >> 7;
+    int64_t denom = ((int64_t)x_ac * y_dc_max) >> 7;
+    if (denom <= 0 || nume == 0) {
+        return;
+    }
+
+    st.ratios[st.ratio_head] = (int32_t)((nume * 100) / denom);
+    st.ratio_idx[st.ratio_head] = v1;
+    st.ratio_head = (st.ratio_head + 1) % SPO2_STREAM_MAX_RATIOS;
+    if (st.ratio_count < SPO2_STREAM_MAX_RATIOS) {
+        st.ratio_count++;
+    }
+}
+
+static void commit_valley(uint32_t idx)
+{
+    if (st.valley_count > 0) {
+        int last = (st.valley_head + SPO2_STREAM_MAX_VALLEYS - 1) % SPO2_STREAM_MAX_VALLEYS;
+        add_beat_ratio(st.valleys[last], idx);
+    }
+
+    st.valleys[st.valley_head] = idx;
+    st.valley_head = (st.valley_head + 1) % SPO2_STREAM_MAX_VALLEYS;
+    if (st.valley_count < SPO2_STREAM_MAX_VALLEYS) {
+        st.valley_count++;
+    }
+}
+
+/**
+ * @brief Keep the higher of two valleys closer than PEAK_MIN_DISTANCE,
+ *        like maxim_remove_close_peaks() does on the full window.
+ */
+static void add_valley(uint32_t idx, int32_t val)
+{
+    if (st.has_pending && idx - st.pending_idx <= PEAK_MIN_DISTANCE) {
+        if (val > st.pending_val) {
+            st.pending_idx = idx;
+            st.pending_val = val;
+        }
+        return;
+    }
+    if (st.has_pending) {
+        commit_valley(st.pending_idx);
+    }
+    st.has_pending = true;
+    st.pending_idx = idx;
+    st.pending_val = val;
+}
+
+static void add_smoothed(int32_t s)
+{
+    uint32_t idx = st.smoothed_count++;
+    int slot = idx % BUFFER_SIZE;
+
+    if (idx >= BUFFER_SIZE) {
+        st.smoothed_sum -= st.smoothed[slot];
+    }
+    st.smoothed[slot] = s;
+    st.smoothed_sum += s;
+
+    uint32_t n = idx < BUFFER_SIZE ? idx + 1 : BUFFER_SIZE;
+    int32_t th = st.smoothed_sum / (int32_t)n;
+    if (th < SPO2_STREAM_MIN_TH) th = SPO2_STREAM_MIN_TH;
+    if (th > SPO2_STREAM_MAX_TH) th = SPO2_STREAM_MAX_TH;
+
+    // a peak is a rise above the threshold followed by a fall; flat tops keep the left edge
+    if (st.in_candidate) {
+        if (s == st.candidate_val) {
+            st.prev_smoothed = s;
+            return;
+        }
+        st.in_candidate = false;
+        if (s < st.candidate_val) {
+            add_valley(st.candidate_idx, st.candidate_val);
+        }
+    }
+    if (idx > 0 && s > th && s > st.prev_smoothed) {
+        st.in_candidate = true;
+        st.candidate_idx = idx;
+        st.candidate_val = s;
+    }
+    st.prev_smoothed = s;
+
+    if (st.has_pending && idx - st.pending_idx > PEAK_MIN_DISTANCE) {
+        commit_valley(st.pending_idx);
+        st.has_pending = false;
+    }
+}
+
+static int32_t median_ratio(void)
+{
+    int32_t sorted[SPO2_STREAM_MAX_RATIOS];
+    int32_t n = 0;
+
+    for (int i = 0; i < st.ratio_count; i++) {
+        if (in_window(st.ratio_idx[i])) {
+            sorted[n++] = st.ratios[i];
+        }
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    maxim_sort_ascend(sorted, n);
+    int32_t mid = n / 2;
+    if (mid > 1) {
+        return (sorted[mid - 1] + sorted[mid]) / 2;
+    }
+    return sorted[mid];
+}
+
+static void publish(spo2_stream_result_t *result)
+{
+    uint32_t first = 0, last = 0;
+    int32_t n = 0;
+
+    for (int i = 0; i < st.valley_count; i++) {
+        int slot = (st.valley_head + SPO2_STREAM_MAX_VALLEYS - st.valley_count + i) % SPO2_STREAM_MAX_VALLEYS;
+        if (!in_window(st.valleys[slot])) {
+            continue;
+        }
+        if (n++ == 0) {
+            first = st.valleys[slot];
+        }
+        last = st.valleys[slot];
+    }
+
+    int32_t interval = n >= 2 ? (int32_t)(last - first) / (n - 1) : 0;
+    if (interval > 0) {
+        result->heart_rate = (FreqS * 60) / interval;
+        result->heart_rate_valid = 1;
+    } else {
+        result->heart_rate = 100;
+        result->heart_rate_valid = 0;
+    }
+
+    int32_t ratio = median_ratio();
+    if (ratio > 2 && ratio < 184) {
+        result->spo2 = uch_spo2_table[ratio];
+        result->spo2_valid = 1;
+    } else {
+        result->spo2 = 100;
+        result->spo2_valid = 0;
+    }
+}
+
+/**
+ * @brief Feed one IR/red sample pair into the streaming SpO2/HR engine.
+ *
+ * @param ir      Raw IR sample
+ * @param red     Raw red sample
+ * @param result  Updated every SPO2_STREAM_UPDATE_INTERVAL samples once the window is full
+ * @return true when @p result holds a newly published value
+ */
+bool spo2_stream_add_sample(uint32_t ir, uint32_t red, spo2_stream_result_t *result)
+{
+    uint32_t idx = st.count;
+    int slot = idx % BUFFER_SIZE;
+
+    if (idx >= BUFFER_SIZE) {
+        st.ir_sum -= st.ir[slot];
+    }
+    st.ir[slot] = ir;
+    st.red[slot] = red;
+    st.ir_sum += ir;
+    st.count++;
+
+    uint32_t n = st.count < BUFFER_SIZE ? st.count : BUFFER_SIZE;
+    int32_t x = -((int32_t)ir - (int32_t)(st.ir_sum / n));
+
+    // MA_SIZE point moving average, aligned to its oldest input like the batch version
+    st.ma_sum -= st.ma_in[idx % MA_SIZE];
+    st.ma_in[idx % MA_SIZE] = x;
+    st.ma_sum += x;
+    if (st.count >= MA_SIZE) {
+        add_smoothed(st.ma_sum / MA_SIZE);
+    }
+
+    if (st.count < BUFFER_SIZE || (st.count - BUFFER_SIZE) % SPO2_STREAM_UPDATE_INTERVAL != 0) {
+        return false;
+    }
+    publish(result);
+    return true;
+}
@@ -0,0 +1,22 @@
+#ifndef SPO2_STREAM_H
+#define SPO2_STREAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "spo2_algorithm.h"
+
+// Publish a new SpO2/HR result every SPO2_STREAM_UPDATE_INTERVAL samples
+#define SPO2_STREAM_UPDATE_INTERVAL SPO2_MS_TO_SAMPLES(CONFIG_SPO2_UPDATE_INTERVAL_MS)
+
+typedef struct {
+    int32_t spo2;
+    int8_t  spo2_valid;
+    int32_t heart_rate;
+    int8_t  heart_rate_valid;
+} spo2_stream_result_t;
+
+void spo2_stream_reset(void);
+bool spo2_stream_add_sample(uint32_t ir, uint32_t red, spo2_stream_result_t *result);
+
+#endif // SPO2_STREAM_H
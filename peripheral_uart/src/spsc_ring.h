@@ -0,0 +1,143 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+/*
+ * Single-producer, single-consumer ring of fixed size elements.
+ *
+ * head counts the elements ever produced and is only written by the producer,
+ * tail counts the elements ever consumed and is only written by the consumer,
+ * so neither side takes a lock and either may run in an ISR. The atomic store
+ * of head publishes the element contents, the one of tail hands the slots
+ * back.
+ *
+ * Elements are accessed in place: the producer fills the contiguous span
+ * returned by spsc_ring_write_span() and commits it, the consumer reads the
+ * span returned by spsc_ring_read_span() (or any element by its offset from
+ * the oldest) and then consumes it. A span ends at the end of the buffer, so
+ * draining a wrapped ring takes two spans.
+ */
+
+struct spsc_ring {
+    uint8_t *buf;
+    uint16_t elem_size;
+    uint32_t mask;              // capacity - 1, capacity is a power of two
+    atomic_t head;
+    atomic_t tail;
+};
+
+/**
+ * @brief Define a static ring of @p _capacity elements of @p _type.
+ */
+#define SPSC_RING_DEFINE(_name, _type, _capacity)                                 \
+    BUILD_ASSERT(IS_POWER_OF_TWO(_capacity), "capacity must be a power of two");  \
+    static _type _name##_elems[_capacity];                                        \
+    static struct spsc_ring _name = {                                             \
+        .buf = (uint8_t *)_name##_elems,                                          \
+        .elem_size = sizeof(_type),                                               \
+        .mask = (_capacity) - 1,                                                  \
+    }
+
+static inline uint32_t spsc_ring_capacity(const struct spsc_ring *r)
+{
+    return r->mask + 1;
+}
+
+/**
+ * @brief Elements ready for the consumer. Exact on the consumer side, a lower
+ *        bound anywhere else.
+ */
+static inline uint32_t spsc_ring_count(struct spsc_ring *r)
+{
+    return (uint32_t)atomic_get(&r->head) - (uint32_t)atomic_get(&r->tail);
+}
+
+/**
+ * @brief Free slots. Exact on the producer side, a lower bound anywhere else.
+ */
+static inline uint32_t spsc_ring_space(struct spsc_ring *r)
+{
+    return spsc_ring_capacity(r) - spsc_ring_count(r);
+}
+
+/**
+ * @brief Contiguous free slots starting at the next element to produce.
+ *        Producer only.
+ *
+ * @param span  Set to the first free slot
+ * @return Number of slots in the span, 0 if the ring is full
+ */
+static inline uint32_t spsc_ring_write_span(struct spsc_ring *r, void **span)
+{
+    uint32_t head = atomic_get(&r->head);
+    uint32_t offset = head & r->mask;
+
+    *span = &r->buf[offset * r->elem_size];
+    return MIN(spsc_ring_space(r), spsc_ring_capacity(r) - offset);
+}
+
+/**
+ * @brief Publish @p n elements written in place. Producer only.
+ */
+static inline void spsc_ring_commit(struct spsc_ring *r, uint32_t n)
+{
+    atomic_set(&r->head, (uint32_t)atomic_get(&r->head) + n);
+}
+
+/**
+ * @brief Copy one element in. Producer only.
+ *
+ * @return false, leaving the ring unchanged, if it is full
+ */
+static inline bool spsc_ring_put(struct spsc_ring *r, const void *elem)
+{
+    void *slot;
+
+    if (spsc_ring_write_span(r, &slot) == 0) {
+        return false;
+    }
+    memcpy(slot, elem, r->elem_size);
+    spsc_ring_commit(r, 1);
+    return true;
+}
+
+/**
+ * @brief Contiguous produced elements starting at the oldest. Consumer only.
+ *
+ * @param span  Set to the oldest element
+ * @return Number of elements in the span, 0 if the ring is empty
+ */
+static inline uint32_t spsc_ring_read_span(struct spsc_ring *r, void **span)
+{
+    uint32_t tail = atomic_get(&r->tail);
+    uint32_t offset = tail & r->mask;
+
+    *span = &r->buf[offset * r->elem_size];
+    return MIN(spsc_ring_count(r), spsc_ring_capacity(r) - offset);
+}
+
+/**
+ * @brief Element @p i counted from the oldest, without consuming anything.
+ *        Consumer only; @p i must be below spsc_ring_count().
+ */
+static inline void *spsc_ring_peek(struct spsc_ring *r, uint32_t i)
+{
+    uint32_t offset = ((uint32_t)atomic_get(&r->tail) + i) & r->mask;
+
+    return &r->buf[offset * r->elem_size];
+}
+
+/**
+ * @brief Release the @p n oldest elements to the producer. Consumer only.
+ */
+static inline void spsc_ring_consume(struct spsc_ring *r, uint32_t n)
+{
+    atomic_set(&r->tail, (uint32_t)atomic_get(&r->tail) + n);
+}
+
+#endif // SPSC_RING_H
@@ -0,0 +1,103 @@
+#ifndef TELEMETRY_SCHEMA_H
+#define TELEMETRY_SCHEMA_H
+
+/*
+ * Binary telemetry frame, shared by the firmware encoder (aggregator.c) and
+ * the host decoder (tools/telemetry_decode.c). Plain C only, no Zephyr headers.
+ *
+ * Frame layout, little endian:
+ *   u8   version           TELEMETRY_VERSION
+ *   u8   schema id         TELEMETRY_SCHEMA_ID
+ *   u16  sequence number   incremented per frame
+ *   u32  present mask      bit n set if field n is in the frame
+ *   u8   flags             TELEMETRY_FLAG_*
+ *   u64  timestamp         time the frame was built, us since boot
+ *   u8   stream mask       bit n set if timing of waveform stream n follows
+ *   timing[]               one per stream in the mask, in stream order
+ *   summary[]              one per present field, in field order
+ *   u16  CRC-16/CCITT      over every preceding byte
+ *
+ * Stream timing ties the summaries to the sample streams (waveform.h), which
+ * share the frame's time base:
+ *   u32  last block        time of the newest sample acquired, us since boot
+ *                          (low 32 bits, at most one wrap before the frame)
+ *   u32  rate              effective sample rate, mHz
+ *
+ * Each summary covers every sample added during the reporting interval:
+ *   u8   count             samples, saturated at 255
+ *   i16  mean
+ *   i16  min
+ *   i16  max
+ *   u16  stddev            in 1/16 value units, only if TELEMETRY_FLAG_STDDEV is set
+ *
+ * A value on the wire is round(physical value * scale).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define TELEMETRY_VERSION   3
+#define TELEMETRY_SCHEMA_ID 1
+
+/* X(name, scale, unit) */
+#define TELEMETRY_FIELDS(X)                  \
+    X(ACCEL_X,        100, "g")              \
+    X(ACCEL_Y,        100, "g")              \
+    X(ACCEL_Z,        100, "g")              \
+    X(STEP_RATE,        1, "steps/min")      \
+    X(GYRO_X,          10, "deg/s")          \
+    X(GYRO_Y,          10, "deg/s")          \
+    X(GYRO_Z,          10, "deg/s")          \
+    X(ROTATION_RATE,    1, "rotations/min")  \
+    X(AMBIENT_TEMP,   100, "degC")           \
+    X(OBJECT_TEMP,    100, "degC")           \
+    X(PRESSURE,        10, "hPa")            \
+    X(BREATH_AVG,       1, "mV")             \
+    X(BREATH_RATE,      1, "breaths/min")    \
+    X(PULSE_MV,         1, "mV")             \
+    X(PULSE_BPM,        1, "BPM")            \
+    X(SPO2,             1, "%")
+
+enum telemetry_field {
+#define TELEMETRY_ENUM(name, scale, unit) TELEMETRY_##name,
+    TELEMETRY_FIELDS(TELEMETRY_ENUM)
+#undef TELEMETRY_ENUM
+    TELEMETRY_FIELD_COUNT
+};
+
+static const int16_t telemetry_field_scale[TELEMETRY_FIELD_COUNT] = {
+#define TELEMETRY_SCALE(name, scale, unit) scale,
+    TELEMETRY_FIELDS(TELEMETRY_SCALE)
+#undef TELEMETRY_SCALE
+};
+
+#define TELEMETRY_FLAG_STDDEV    0x01
+#define TELEMETRY_STDDEV_FRAC_BITS 4
+
+/* PPG, ADC, IMU, as enum waveform_stream */
+#define TELEMETRY_STREAM_COUNT   3
+
+#define TELEMETRY_HEADER_SIZE    17
+#define TELEMETRY_TIMING_SIZE    8
+#define TELEMETRY_CRC_SIZE       2
+#define TELEMETRY_SUMMARY_SIZE(flags) (7 + (((flags) & TELEMETRY_FLAG_STDDEV) ? 2 : 0))
+#define TELEMETRY_MAX_FRAME_SIZE (TELEMETRY_HEADER_SIZE + \
+                                  1 + TELEMETRY_TIMING_SIZE * TELEMETRY_STREAM_COUNT + \
+                                  TELEMETRY_SUMMARY_SIZE(TELEMETRY_FLAG_STDDEV) * TELEMETRY_FIELD_COUNT + \
+                                  TELEMETRY_CRC_SIZE)
+
+/* CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) */
+static inline uint16_t telemetry_crc16(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+#endif // TELEMETRY_SCHEMA_H
@@ -0,0 +1,222 @@
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/printk.h>
+
+#include "timestamp.h"
+
+/*
+ * The rate of a stream is measured between two anchors, each the newest
+ * sample of a block: the older anchor is at least ANCHOR_INTERVAL_MS behind
+ * the block being recorded and at most twice that, so the jitter of a polled
+ * block timestamp (up to one read period) stays well below 1% of the span
+ * while the estimate still follows a drifting sensor oscillator. Time the
+ * stream reported as a gap is left out of the span.
+ */
+#define ANCHOR_INTERVAL_MS 10000
+#define PERIOD_FRAC_BITS 16
+
+struct stream_anchor {
+    uint64_t cycles;
+    uint64_t gaps;              // gap cycles recorded before the anchor sample
+    uint32_t index;             // samples recorded before the anchor sample
+};
+
+struct stream_timing {
+    bool started;
+    uint32_t samples;
+    uint64_t last;              // newest sample of the last block
+    uint64_t gaps;              // cycles spent in reported gaps
+    uint64_t period;            // cycles per sample << PERIOD_FRAC_BITS
+    struct stream_anchor older, newer;
+};
+
+static struct stream_timing streams[WAVEFORM_STREAM_COUNT];
+static struct k_spinlock stream_lock;
+
+#ifndef CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER
+static uint32_t cycles_last;
+static uint32_t cycles_wraps;
+static struct k_spinlock cycles_lock;
+
+// keeps the wrap count current while no sample is timestamped
+static void timestamp_wrap_handler(struct k_timer *timer)
+{
+    (void)timestamp_now();
+}
+
+static K_TIMER_DEFINE(timestamp_wrap_timer, timestamp_wrap_handler, NULL);
+#endif
+
+uint64_t timestamp_now(void)
+{
+#ifdef CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER
+    return k_cycle_get_64();
+#else
+    k_spinlock_key_t key = k_spin_lock(&cycles_lock);
+    uint32_t now = k_cycle_get_32();
+
+    if (now < cycles_last) {
+        cycles_wraps++;
+    }
+    cycles_last = now;
+    uint64_t cycles = ((uint64_t)cycles_wraps << 32) | now;
+
+    k_spin_unlock(&cycles_lock, key);
+    return cycles;
+#endif
+}
+
+uint64_t timestamp_to_us(uint64_t cycles)
+{
+    return k_cyc_to_us_floor64(cycles);
+}
+
+uint32_t timestamp_to_ms(uint64_t cycles)
+{
+    return (uint32_t)k_cyc_to_ms_floor64(cycles);
+}
+
+void timestamp_stream_init(enum waveform_stream stream, uint32_t nominal_hz)
+{
+    k_spinlock_key_t key = k_spin_lock(&stream_lock);
+
+    streams[stream].period = ((uint64_t)sys_clock_hw_cycles_per_sec() << PERIOD_FRAC_BITS) /
+                             nominal_hz;
+    streams[stream].started = false;
+
+    k_spin_unlock(&stream_lock, key);
+}
+
+void timestamp_stream_block(enum waveform_stream stream, uint64_t newest, uint32_t samples)
+{
+    struct stream_timing *s = &streams[stream];
+    const uint64_t interval = k_ms_to_cyc_floor64(ANCHOR_INTERVAL_MS);
+
+    if (samples == 0) {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&stream_lock);
+
+    s->samples += samples;
+    s->last = newest;
+
+    struct stream_anchor now = { .cycles = newest, .gaps = s->gaps, .index = s->samples - 1 };
+
+    if (!s->started) {
+        s->older = s->newer = now;
+        s->started = true;
+    } else if (newest - s->newer.cycles >= interval) {
+        s->older = s->newer;
+        s->newer = now;
+    }
+
+    uint64_t span = newest - s->older.cycles;
+    uint64_t gaps = s->gaps - s->older.gaps;
+    if (span >= interval && span > gaps) {
+        s->period = ((span - gaps) << PERIOD_FRAC_BITS) / (now.index - s->older.index);
+    }
+
+    k_spin_unlock(&stream_lock, key);
+}
+
+void timestamp_stream_restart(enum waveform_stream stream)
+{
+    k_spinlock_key_t key = k_spin_lock(&stream_lock);
+
+    // the rate measured so far stays in use until the new span is long enough
+    streams[stream].started = false;
+
+    k_spin_unlock(&stream_lock, key);
+}
+
+uint64_t timestamp_stream_gap(enum waveform_stream stream, uint64_t next)
+{
+    struct stream_timing *s = &streams[stream];
+    uint64_t gap = 0;
+    k_spinlock_key_t key = k_spin_lock(&stream_lock);
+
+    if (s->started) {
+        uint64_t expected = s->last + (s->period >> PERIOD_FRAC_BITS);
+
+        if (next > expected) {
+            gap = next - expected;
+            s->gaps += gap;
+        }
+    }
+
+    k_spin_unlock(&stream_lock, key);
+    return gap;
+}
+
+static uint64_t stream_period(enum waveform_stream stream)
+{
+    k_spinlock_key_t key = k_spin_lock(&stream_lock);
+    uint64_t period = streams[stream].period;
+
+    k_spin_unlock(&stream_lock, key);
+    return period;
+}
+
+uint64_t timestamp_stream_sample(enum waveform_stream stream, uint64_t ref, int32_t offset)
+{
+    uint64_t samples = offset < 0 ? -(int64_t)offset : offset;
+    uint64_t span = (samples * stream_period(stream)) >> PERIOD_FRAC_BITS;
+
+    return offset < 0 ? ref - span : ref + span;
+}
+
+uint32_t timestamp_stream_period_ns(enum waveform_stream stream)
+{
+    // split the fraction shift so a 64 MHz counter cannot overflow
+    uint64_t period = stream_period(stream) >> (PERIOD_FRAC_BITS / 2);
+
+    return (uint32_t)((period * NSEC_PER_SEC / sys_clock_hw_cycles_per_sec()) >>
+                      (PERIOD_FRAC_BITS / 2));
+}
+
+bool timestamp_stream_get(enum waveform_stream stream, struct timestamp_stream_info *out)
+{
+    const struct stream_timing *s = &streams[stream];
+    k_spinlock_key_t key = k_spin_lock(&stream_lock);
+
+    bool recorded = s->samples > 0;
+    out->samples = s->samples;
+    out->last_us = timestamp_to_us(s->last);
+    out->rate_mhz = s->period ? (uint32_t)(((uint64_t)sys_clock_hw_cycles_per_sec() * 1000
+                                            << PERIOD_FRAC_BITS) / s->period)
+                              : 0;
+
+    k_spin_unlock(&stream_lock, key);
+    return recorded;
+}
+
+void timestamp_print_stats(void)
+{
+    static const char *const names[WAVEFORM_STREAM_COUNT] = { "PPG", "ADC", "IMU" };
+
+    for (int i = 0; i < WAVEFORM_STREAM_COUNT; i++) {
+        struct timestamp_stream_info info;
+
+        if (!timestamp_stream_get(i, &info)) {
+            continue;
+        }
+        printk("Timing %s: %u samples, %u.%03u Hz, last at %u ms\n", names[i], info.samples,
+               info.rate_mhz / 1000, info.rate_mhz % 1000, (uint32_t)(info.last_us / 1000));
+    }
+}
+
+static int timestamp_init(void)
+{
+#ifndef CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER
+    // four checks per wrap of the 32 bit counter (36 h at 32768 Hz)
+    uint32_t period_ms = (uint32_t)(((uint64_t)UINT32_MAX * MSEC_PER_SEC /
+                                     sys_clock_hw_cycles_per_sec()) / 4);
+
+    k_timer_start(&timestamp_wrap_timer, K_MSEC(period_ms), K_MSEC(period_ms));
+#endif
+    return 0;
+}
+
+SYS_INIT(timestamp_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,97 @@
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include <stdint.h>
+
+#include "waveform.h"
+
+/*
+ * Common acquisition time base: the hardware cycle counter, extended to 64
+ * bits. Every sample block is stamped with timestamp_now() in the interrupt
+ * or DMA completion that delivers it, so PPG, ADC and IMU samples share one
+ * timeline. On the wire timestamps are microseconds since boot.
+ *
+ * Each stream also tracks its effective sample rate from the block
+ * timestamps, so per-sample times follow the sensor's own clock rather than
+ * its nominal rate.
+ *
+ * The counter is the system timer, the 32768 Hz RTC on the nRF52840, not
+ * the 64 MHz DWT cycle counter: CYCCNT only advances while the core is
+ * clocked and stops whenever the idle thread sleeps in WFI, which is most
+ * of the time between two sample blocks. The 30.5 us tick only limits where
+ * a block is anchored; the samples within it are placed at the measured
+ * period with PERIOD_FRAC_BITS of fraction, and the 10 s rate span makes
+ * the tick a 3 ppm error. The stamp is taken after an interrupt or thread
+ * wake-up whose latency is of the same order as the tick.
+ */
+
+// Set to true to print the estimated rate of every stream with the other stats
+#define REPORT_TIMESTAMP_STATS false
+
+struct timestamp_stream_info {
+    uint32_t samples;           // samples recorded since boot
+    uint64_t last_us;           // newest sample of the last block
+    uint32_t rate_mhz;          // effective sample rate, mHz
+};
+
+/**
+ * @brief Current time in hardware cycles. Callable from ISRs.
+ */
+uint64_t timestamp_now(void);
+
+uint64_t timestamp_to_us(uint64_t cycles);
+
+/**
+ * @brief Uptime in ms of a timestamp, the unit of the event rate calculators.
+ */
+uint32_t timestamp_to_ms(uint64_t cycles);
+
+/**
+ * @brief Set the rate a stream is assumed to run at until it is measured.
+ */
+void timestamp_stream_init(enum waveform_stream stream, uint32_t nominal_hz);
+
+/**
+ * @brief Record a block of consecutive samples.
+ *
+ * @param stream   Stream the block belongs to
+ * @param newest   timestamp_now() at which the newest sample was taken
+ * @param samples  Samples in the block
+ */
+void timestamp_stream_block(enum waveform_stream stream, uint64_t newest, uint32_t samples);
+
+/**
+ * @brief Report that sampling paused after the last recorded block.
+ *
+ * The stream's next sample is taken at @p next instead of one period after
+ * the newest recorded one. The time in between is left out of the rate
+ * estimate.
+ *
+ * @return The gap in cycles, beyond the one sample period
+ */
+uint64_t timestamp_stream_gap(enum waveform_stream stream, uint64_t next);
+
+/**
+ * @brief Restart the rate estimate after samples were lost.
+ */
+void timestamp_stream_restart(enum waveform_stream stream);
+
+/**
+ * @brief Time of the sample @p offset samples after the one taken at @p ref
+ *        (before it if negative), at the stream's effective rate.
+ */
+uint64_t timestamp_stream_sample(enum waveform_stream stream, uint64_t ref, int32_t offset);
+
+/**
+ * @brief Effective sample period in ns, the nominal one until measured.
+ */
+uint32_t timestamp_stream_period_ns(enum waveform_stream stream);
+
+/**
+ * @return false if the stream has not recorded any block yet
+ */
+bool timestamp_stream_get(enum waveform_stream stream, struct timestamp_stream_info *out);
+
+void timestamp_print_stats(void);
+
+#endif // TIMESTAMP_H
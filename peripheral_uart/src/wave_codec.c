@@ -0,0 +1,230 @@
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "wave_codec.h"
+
+typedef struct {
+    uint8_t *buf;
+    int size;
+    int pos;
+    uint32_t acc;
+    int nbits;
+    bool overflow;
+} bit_writer_t;
+
+typedef struct {
+    const uint8_t *buf;
+    int size;
+    int pos;
+    uint32_t acc;
+    int nbits;
+    bool overflow;
+} bit_reader_t;
+
+static inline uint32_t zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t u)
+{
+    return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+}
+
+static inline int32_t residual(const int32_t *x, int stride, int i, int order)
+{
+    int32_t r = x[i * stride] - x[(i - 1) * stride];
+    if (order == 2) {
+        r -= x[(i - 1) * stride] - x[(i - 2) * stride];
+    }
+    return r;
+}
+
+// ---------------- bit I/O ----------------
+static void put_byte(bit_writer_t *w, uint8_t b)
+{
+    if (w->pos == w->size) {
+        w->overflow = true;
+        return;
+    }
+    w->buf[w->pos++] = b;
+}
+
+static void put_bits(bit_writer_t *w, uint32_t v, int n)
+{
+    // split so the 32 bit accumulator never holds more than 8 + 16 bits
+    if (n > 16) {
+        put_bits(w, v >> 16, n - 16);
+        n = 16;
+    }
+    w->acc = (w->acc << n) | (v & ((1UL << n) - 1));
+    w->nbits += n;
+    while (w->nbits >= 8) {
+        w->nbits -= 8;
+        put_byte(w, w->acc >> w->nbits);
+    }
+}
+
+static void flush_bits(bit_writer_t *w)
+{
+    if (w->nbits > 0) {
+        put_byte(w, w->acc << (8 - w->nbits));
+    }
+    w->acc = 0;
+    w->nbits = 0;
+}
+
+static void put_varint(bit_writer_t *w, uint32_t v)
+{
+    while (v >= 0x80) {
+        put_byte(w, (v & 0x7F) | 0x80);
+        v >>= 7;
+    }
+    put_byte(w, v);
+}
+
+static void put_rice(bit_writer_t *w, uint32_t u, int k)
+{
+    uint32_t q = u >> k;
+
+    if (q >= WAVE_CODEC_RICE_ESCAPE) {
+        put_bits(w, (1UL << WAVE_CODEC_RICE_ESCAPE) - 1, WAVE_CODEC_RICE_ESCAPE);
+        put_bits(w, u, 32);
+        return;
+    }
+    // q ones and a terminating zero
+    put_bits(w, ((1UL << q) - 1) << 1, q + 1);
+    if (k > 0) {
+        put_bits(w, u, k);
+    }
+}
+
+static int get_byte(bit_reader_t *r)
+{
+    if (r->pos == r->size) {
+        r->overflow = true;
+        return 0;
+    }
+    return r->buf[r->pos++];
+}
+
+static uint32_t get_bits(bit_reader_t *r, int n)
+{
+    if (n > 16) {
+        uint32_t hi = get_bits(r, n - 16);
+        return (hi << 16) | get_bits(r, 16);
+    }
+    while (r->nbits < n) {
+        r->acc = (r->acc << 8) | get_byte(r);
+        r->nbits += 8;
+    }
+    r->nbits -= n;
+    return (r->acc >> r->nbits) & ((1UL << n) - 1);
+}
+
+static uint32_t get_varint(bit_reader_t *r)
+{
+    uint32_t v = 0;
+
+    for (int shift = 0; shift < 35; shift += 7) {
+        int b = get_byte(r);
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return v;
+        }
+    }
+    r->overflow = true;
+    return 0;
+}
+
+static uint32_t get_rice(bit_reader_t *r, int k)
+{
+    uint32_t q = 0;
+
+    while (q < WAVE_CODEC_RICE_ESCAPE && get_bits(r, 1)) {
+        q++;
+    }
+    if (q == WAVE_CODEC_RICE_ESCAPE) {
+        return get_bits(r, 32);
+    }
+    return (q << k) | (k > 0 ? get_bits(r, k) : 0);
+}
+
+// ---------------- codec ----------------
+static int choose_k(uint64_t sum, int n)
+{
+    int k = 0;
+
+    // Rice parameter close to log2 of the mean residual
+    while (k < WAVE_CODEC_MAX_K && ((uint64_t)n << (k + 1)) <= sum) {
+        k++;
+    }
+    return k;
+}
+
+int wave_codec_encode(const int32_t *samples, int count, int channels,
+                      uint8_t *out, int out_size)
+{
+    bit_writer_t w = { .buf = out, .size = out_size };
+
+    for (int ch = 0; ch < channels; ch++) {
+        const int32_t *x = &samples[ch];
+        uint64_t sum1 = 0, sum2 = 0;
+
+        for (int i = 2; i < count; i++) {
+            sum1 += zigzag(residual(x, channels, i, 1));
+            sum2 += zigzag(residual(x, channels, i, 2));
+        }
+
+        int order = (count > 2 && sum2 < sum1) ? 2 : 1;
+        if (order > count) {
+            order = count;
+        }
+        int k = choose_k(order == 2 ? sum2 : sum1, count > 2 ? count - 2 : 1);
+
+        put_byte(&w, (order << 6) | k);
+        for (int i = 0; i < order; i++) {
+            put_varint(&w, zigzag(x[i * channels]));
+        }
+        for (int i = order; i < count; i++) {
+            put_rice(&w, zigzag(residual(x, channels, i, order)), k);
+        }
+        flush_bits(&w);
+    }
+
+    return w.overflow ? -1 : w.pos;
+}
+
+int wave_codec_decode(const uint8_t *in, int in_len, int count, int channels,
+                      int32_t *samples)
+{
+    bit_reader_t r = { .buf = in, .size = in_len };
+
+    for (int ch = 0; ch < channels; ch++) {
+        int32_t *x = &samples[ch];
+        int hdr = get_byte(&r);
+        int order = hdr >> 6;
+        int k = hdr & 0x1F;
+
+        if (order > 2 || k > WAVE_CODEC_MAX_K || (order == 0 && count > 0)) {
+            return -1;
+        }
+        for (int i = 0; i < order && i < count; i++) {
+            x[i * channels] = unzigzag(get_varint(&r));
+        }
+        for (int i = order; i < count; i++) {
+            int32_t pred = x[(i - 1) * channels];
+            if (order == 2) {
+                pred += x[(i - 1) * channels] - x[(i - 2) * channels];
+            }
+            x[i * channels] = pred + unzigzag(get_rice(&r, k));
+        }
+        r.nbits = 0;
+
+        if (r.overflow) {
+            return -1;
+        }
+    }
+
+    return r.pos;
+}
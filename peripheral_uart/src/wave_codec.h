@@ -0,0 +1,39 @@
+#ifndef WAVE_CODEC_H
+#define WAVE_CODEC_H
+
+#include <stdint.h>
+
+/*
+ * Lossless block codec for slowly varying sensor waveforms, shared by the
+ * firmware (waveform.c) and the host tools. Plain C only.
+ *
+ * Samples are interleaved [count][channels]; each channel is coded on its own:
+ *   u8      order << 6 | rice k
+ *   varint  the first `order` samples, zigzag LEB128
+ *   bits    Rice(k) coded zigzag residuals of the order 1 or 2 predictor,
+ *           MSB first, padded to a byte boundary
+ * A residual whose quotient reaches WAVE_CODEC_RICE_ESCAPE is sent as that
+ * many one bits followed by its 32 bit zigzag value.
+ *
+ * Values must fit in 28 bits so second order residuals cannot overflow.
+ */
+#define WAVE_CODEC_RICE_ESCAPE 20
+#define WAVE_CODEC_MAX_K       24
+
+/**
+ * @brief Encode a block of samples.
+ *
+ * @return Encoded size in bytes, or -1 if it does not fit in @p out_size
+ */
+int wave_codec_encode(const int32_t *samples, int count, int channels,
+                      uint8_t *out, int out_size);
+
+/**
+ * @brief Decode a block produced by wave_codec_encode().
+ *
+ * @return Number of bytes consumed, or -1 on malformed input
+ */
+int wave_codec_decode(const uint8_t *in, int in_len, int count, int channels,
+                      int32_t *samples);
+
+#endif // WAVE_CODEC_H
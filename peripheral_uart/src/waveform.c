@@ -0,0 +1,242 @@
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/uuid.h>
+
+#include "waveform.h"
+#include "ble_link.h"
+#include "ble_tx.h"
+#include "wave_codec.h"
+#include "timestamp.h"
+
+// Keeps a block inside one notification at the negotiated 247 byte MTU
+BUILD_ASSERT(CONFIG_WAVEFORM_BLOCK_SIZE <= CONFIG_BLE_TX_MAX_FRAME_SIZE,
+             "waveform blocks must fit in the notification TX queue");
+
+#define BT_UUID_WAVEFORM_SERVICE_VAL \
+    BT_UUID_128_ENCODE(0x4c560100, 0x5741, 0x5645, 0x8a1e, 0x4c756e617200)
+#define BT_UUID_WAVEFORM_PPG_VAL \
+    BT_UUID_128_ENCODE(0x4c560101, 0x5741, 0x5645, 0x8a1e, 0x4c756e617200)
+#define BT_UUID_WAVEFORM_ADC_VAL \
+    BT_UUID_128_ENCODE(0x4c560102, 0x5741, 0x5645, 0x8a1e, 0x4c756e617200)
+#define BT_UUID_WAVEFORM_IMU_VAL \
+    BT_UUID_128_ENCODE(0x4c560103, 0x5741, 0x5645, 0x8a1e, 0x4c756e617200)
+
+#define BT_UUID_WAVEFORM_SERVICE BT_UUID_DECLARE_128(BT_UUID_WAVEFORM_SERVICE_VAL)
+#define BT_UUID_WAVEFORM_PPG     BT_UUID_DECLARE_128(BT_UUID_WAVEFORM_PPG_VAL)
+#define BT_UUID_WAVEFORM_ADC     BT_UUID_DECLARE_128(BT_UUID_WAVEFORM_ADC_VAL)
+#define BT_UUID_WAVEFORM_IMU     BT_UUID_DECLARE_128(BT_UUID_WAVEFORM_IMU_VAL)
+
+#define BLOCK_PAYLOAD (CONFIG_WAVEFORM_BLOCK_SIZE - WAVEFORM_HEADER_SIZE)
+#define RAW_CAPACITY(channels, value_size) (BLOCK_PAYLOAD / ((channels) * (value_size)))
+
+#ifdef CONFIG_WAVEFORM_COMPRESSION
+// stage more samples than fit raw, the coded block usually still fits
+#define STAGE_CAPACITY(channels, value_size) MIN(4 * RAW_CAPACITY(channels, value_size), UINT8_MAX)
+#else
+#define STAGE_CAPACITY(channels, value_size) RAW_CAPACITY(channels, value_size)
+#endif
+
+#define PPG_STAGE STAGE_CAPACITY(2, 3)
+#define ADC_STAGE STAGE_CAPACITY(2, 2)
+#define IMU_STAGE STAGE_CAPACITY(6, 2)
+
+struct waveform_block {
+    uint8_t channels;
+    uint8_t value_size;         // bytes per value of the raw format
+    uint8_t capacity;           // samples staged before a block is coded
+    uint8_t staged;
+    uint8_t sequence;
+    int32_t *values;            // [capacity][channels]
+    uint32_t *timestamps;       // [capacity], us
+    struct waveform_stats stats;
+    uint8_t block[CONFIG_WAVEFORM_BLOCK_SIZE];
+};
+
+static int32_t ppg_values[PPG_STAGE * 2], adc_values[ADC_STAGE * 2], imu_values[IMU_STAGE * 6];
+static uint32_t ppg_times[PPG_STAGE], adc_times[ADC_STAGE], imu_times[IMU_STAGE];
+
+static struct waveform_block blocks[WAVEFORM_STREAM_COUNT] = {
+    [WAVEFORM_PPG] = { .channels = 2, .value_size = 3, .capacity = PPG_STAGE,
+                       .values = ppg_values, .timestamps = ppg_times },
+    [WAVEFORM_ADC] = { .channels = 2, .value_size = 2, .capacity = ADC_STAGE,
+                       .values = adc_values, .timestamps = adc_times },
+    [WAVEFORM_IMU] = { .channels = 6, .value_size = 2, .capacity = IMU_STAGE,
+                       .values = imu_values, .timestamps = imu_times },
+};
+
+static atomic_t enabled_streams;
+// streams whose staged samples the producer drops before its next push
+static atomic_t reset_streams;
+
+static void ccc_changed(enum waveform_stream stream, uint16_t value)
+{
+    if (value == BT_GATT_CCC_NOTIFY) {
+        // the staging buffer belongs to the producer thread, so it clears it
+        atomic_set_bit(&reset_streams, stream);
+        atomic_set_bit(&enabled_streams, stream);
+    } else {
+        atomic_clear_bit(&enabled_streams, stream);
+    }
+    printk("Waveform stream %d %s\n", stream, value == BT_GATT_CCC_NOTIFY ? "on" : "off");
+
+    ble_link_request_stream(BLE_LINK_USER_WAVEFORM, atomic_get(&enabled_streams) != 0);
+}
+
+static void ppg_ccc_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+    ccc_changed(WAVEFORM_PPG, value);
+}
+
+static void adc_ccc_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+    ccc_changed(WAVEFORM_ADC, value);
+}
+
+static void imu_ccc_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+    ccc_changed(WAVEFORM_IMU, value);
+}
+
+BT_GATT_SERVICE_DEFINE(waveform_service,
+    BT_GATT_PRIMARY_SERVICE(BT_UUID_WAVEFORM_SERVICE),
+    BT_GATT_CHARACTERISTIC(BT_UUID_WAVEFORM_PPG, BT_GATT_CHRC_NOTIFY,
+                           BT_GATT_PERM_NONE, NULL, NULL, NULL),
+    BT_GATT_CCC(ppg_ccc_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+    BT_GATT_CHARACTERISTIC(BT_UUID_WAVEFORM_ADC, BT_GATT_CHRC_NOTIFY,
+                           BT_GATT_PERM_NONE, NULL, NULL, NULL),
+    BT_GATT_CCC(adc_ccc_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+    BT_GATT_CHARACTERISTIC(BT_UUID_WAVEFORM_IMU, BT_GATT_CHRC_NOTIFY,
+                           BT_GATT_PERM_NONE, NULL, NULL, NULL),
+    BT_GATT_CCC(imu_ccc_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+);
+
+// characteristic declaration of each stream; the value follows it
+static const struct bt_gatt_attr *const stream_attr[WAVEFORM_STREAM_COUNT] = {
+    [WAVEFORM_PPG] = &waveform_service.attrs[1],
+    [WAVEFORM_ADC] = &waveform_service.attrs[4],
+    [WAVEFORM_IMU] = &waveform_service.attrs[7],
+};
+
+bool waveform_stream_enabled(enum waveform_stream stream)
+{
+    return atomic_test_bit(&enabled_streams, stream);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = v >> 24;
+}
+
+static int pack_raw(const struct waveform_block *b, int count, uint8_t *out)
+{
+    uint8_t *p = out;
+
+    for (int n = 0; n < count * b->channels; n++) {
+        for (int i = 0; i < b->value_size; i++) {
+            *p++ = (uint32_t)b->values[n] >> (8 * i);
+        }
+    }
+    return p - out;
+}
+
+/**
+ * @brief Send the oldest staged samples as one block, compressed when that is
+ *        smaller than the raw format, and keep the rest staged.
+ */
+static void send_block(enum waveform_stream stream)
+{
+    struct waveform_block *b = &blocks[stream];
+    uint8_t *payload = &b->block[WAVEFORM_HEADER_SIZE];
+    int raw_capacity = RAW_CAPACITY(b->channels, b->value_size);
+    int count = b->staged;
+    int len = -1;
+    uint8_t format = (b->channels << 4) | b->value_size;
+
+#ifdef CONFIG_WAVEFORM_COMPRESSION
+    uint32_t start = k_cycle_get_32();
+
+    // shrink the block until the coded samples fit
+    while (count > 0) {
+        len = wave_codec_encode(b->values, count, b->channels, payload, BLOCK_PAYLOAD);
+        if (len >= 0 || count <= raw_capacity) {
+            break;
+        }
+        count = MAX(count * 3 / 4, raw_capacity);
+    }
+
+    b->stats.encode_cycles += k_cycle_get_32() - start;
+    if (len >= 0 && len < count * b->channels * b->value_size) {
+        format |= WAVEFORM_FORMAT_COMPRESSED;
+    } else {
+        count = MIN(count, raw_capacity);
+        len = -1;
+    }
+#endif
+    if (len < 0) {
+        len = pack_raw(b, count, payload);
+    }
+
+    b->block[0] = stream;
+    b->block[1] = format;
+    b->block[2] = count;
+    b->block[3] = b->sequence++;
+    put_le32(&b->block[4], b->timestamps[0]);
+    put_le32(&b->block[8], timestamp_stream_period_ns(stream));
+    ble_tx_send(stream_attr[stream], b->block, WAVEFORM_HEADER_SIZE + len);
+
+    b->stats.samples += count;
+    b->stats.raw_bytes += count * b->channels * b->value_size;
+    b->stats.sent_bytes += len;
+
+    b->staged -= count;
+    memmove(b->values, &b->values[count * b->channels], b->staged * b->channels * sizeof(int32_t));
+    memmove(b->timestamps, &b->timestamps[count], b->staged * sizeof(uint32_t));
+}
+
+void waveform_push(enum waveform_stream stream, uint32_t timestamp_us, const int32_t *values)
+{
+    struct waveform_block *b = &blocks[stream];
+
+    if (!waveform_stream_enabled(stream)) {
+        return;
+    }
+    if (atomic_test_and_clear_bit(&reset_streams, stream)) {
+        b->staged = 0;
+    }
+
+    memcpy(&b->values[b->staged * b->channels], values, b->channels * sizeof(int32_t));
+    b->timestamps[b->staged] = timestamp_us;
+    b->staged++;
+
+    if (b->staged == b->capacity ||
+        timestamp_us - b->timestamps[0] >= CONFIG_WAVEFORM_MAX_LATENCY_MS * USEC_PER_MSEC) {
+        send_block(stream);
+    }
+}
+
+void waveform_get_stats(enum waveform_stream stream, struct waveform_stats *out)
+{
+    *out = blocks[stream].stats;
+}
+
+void waveform_print_stats(void)
+{
+    static const char *const names[WAVEFORM_STREAM_COUNT] = { "PPG", "ADC", "IMU" };
+
+    for (int i = 0; i < WAVEFORM_STREAM_COUNT; i++) {
+        const struct waveform_stats *s = &blocks[i].stats;
+        if (s->samples == 0) {
+            continue;
+        }
+        printk("Waveform %s: %u samples, %u -> %u bytes (%u%%), %u cycles/sample\n",
+               names[i], s->samples, s->raw_bytes, s->sent_bytes,
+               (uint32_t)((uint64_t)s->sent_bytes * 100 / s->raw_bytes),
+               (uint32_t)(s->encode_cycles / s->samples));
+    }
+}
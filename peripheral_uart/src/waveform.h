@@ -0,0 +1,68 @@
+#ifndef WAVEFORM_H
+#define WAVEFORM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Raw waveform streaming. Each stream has its own notify characteristic in the
+ * waveform service and is only assembled while a client is subscribed to it.
+ * Blocks are sent when the staging buffer is full or its oldest sample is
+ * CONFIG_WAVEFORM_MAX_LATENCY_MS old.
+ *
+ * Sample n of a block was taken at start timestamp + n * sample period, on
+ * the same time base (timestamp.h) for every stream and the telemetry frames,
+ * so a client can resample the streams onto a common timeline.
+ *
+ * The start timestamp is the low 32 bits of the microsecond time and wraps
+ * every 71.6 minutes. A client unwraps it against any 64 bit time within
+ * half a wrap of it, such as the timestamp of a recent telemetry frame or
+ * the unwrapped start of the stream's previous block:
+ *   start_us = ref_us + (int32_t)(start - (uint32_t)ref_us)
+ *
+ * Block layout, little endian:
+ *   u8   stream id         enum waveform_stream
+ *   u8   format            channels << 4 | WAVEFORM_FORMAT_* | bytes per value
+ *   u8   sample count
+ *   u8   block sequence    per stream, to detect lost blocks
+ *   u32  start timestamp   time of the first sample, us since boot (low 32 bits)
+ *   u32  sample period     effective period of the stream, ns
+ *   payload                raw:        value[count][channels], signed,
+ *                                      bytes per value each
+ *                          compressed: wave_codec block of count samples
+ */
+enum waveform_stream {
+    WAVEFORM_PPG,    // MAX30102 red, IR (18 bit ADC counts)
+    WAVEFORM_ADC,    // respiratory, pulse (mV)
+    WAVEFORM_IMU,    // MPU6050 accel x/y/z, gyro x/y/z (raw LSB)
+    WAVEFORM_STREAM_COUNT
+};
+
+#define WAVEFORM_HEADER_SIZE 12
+#define WAVEFORM_MAX_CHANNELS 6
+#define WAVEFORM_FORMAT_COMPRESSED 0x08
+
+struct waveform_stats {
+    uint32_t samples;
+    uint32_t raw_bytes;         // payload size had every block been sent raw
+    uint32_t sent_bytes;        // payload bytes actually queued
+    uint64_t encode_cycles;
+};
+
+bool waveform_stream_enabled(enum waveform_stream stream);
+
+/**
+ * @brief Append one multi-channel sample to the stream's current block; the
+ *        block is queued for notification once it is full. No-op while nobody
+ *        is subscribed to the stream.
+ *
+ * @param stream        Stream the sample belongs to
+ * @param timestamp_us  Time the sample was taken, timestamp_to_us() truncated
+ * @param values        One value per channel of the stream
+ */
+void waveform_push(enum waveform_stream stream, uint32_t timestamp_us, const int32_t *values);
+
+void waveform_get_stats(enum waveform_stream stream, struct waveform_stats *out);
+void waveform_print_stats(void);
+
+#endif // WAVEFORM_H
@@ -0,0 +1,128 @@
+/*
+ * Speed and agreement of event_rate against the timestamp scans it replaced.
+ *
+ * Simulates an hour of walking-like events (debounced, with pauses) and
+ * queries the 20 s rate after every 10 ms sample, once by scanning a
+ * 200 entry timestamp ring like the old calculate_step_rate() and once with
+ * event_rate. Counts may only differ for events within one bucket of the
+ * window edge.
+ *
+ *   event_rate_bench [-w window_ms] [-s seed]
+ *
+ * Build: cc -O2 -o event_rate_bench event_rate_bench.c ../src/event_rate.c
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../src/event_rate.h"
+
+#define HISTORY      200
+#define SAMPLE_MS    10
+#define DURATION_MS  (3600 * 1000)
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint32_t history[HISTORY];
+static int history_index;
+
+static uint32_t scan_count(uint32_t now, uint32_t window_ms)
+{
+    uint32_t count = 0;
+    for (int i = 0; i < HISTORY; i++) {
+        if (history[i] != 0 && now - history[i] <= window_ms) {
+            count++;
+        }
+    }
+    return count;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t window_ms = 20000;
+    unsigned seed = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "w:s:")) != -1) {
+        if (opt == 'w') {
+            window_ms = atoi(optarg);
+        } else if (opt == 's') {
+            seed = atoi(optarg);
+        } else {
+            fprintf(stderr, "usage: %s [-w window_ms] [-s seed]\n", argv[0]);
+            return 1;
+        }
+    }
+    srand(seed);
+
+    // event times first, so both timings only cover insert + query
+    static uint8_t event_at[DURATION_MS / SAMPLE_MS];
+    uint32_t next = 1000;
+    while (next < DURATION_MS) {
+        event_at[next / SAMPLE_MS] = 1;
+        next += 400 + rand() % 300;
+        if (rand() % 100 == 0) {
+            next += rand() % 30000;     // pause
+        }
+    }
+
+    event_rate_t er;
+    uint32_t bucket_ms = window_ms / EVENT_RATE_BUCKETS;
+    volatile uint32_t sink = 0;
+    int samples = DURATION_MS / SAMPLE_MS;
+    int mismatches = 0;
+
+    double t0 = now_ns();
+    for (int i = 1; i < samples; i++) {
+        uint32_t now = (uint32_t)i * SAMPLE_MS;
+        if (event_at[i]) {
+            history[history_index] = now;
+            history_index = (history_index + 1) % HISTORY;
+        }
+        sink += scan_count(now, window_ms);
+    }
+    double scan_ns = now_ns() - t0;
+
+    event_rate_init(&er, window_ms, 0);
+    t0 = now_ns();
+    for (int i = 1; i < samples; i++) {
+        uint32_t now = (uint32_t)i * SAMPLE_MS;
+        if (event_at[i]) {
+            event_rate_add(&er, now);
+        }
+        sink += event_rate_count(&er, now);
+    }
+    double ring_ns = now_ns() - t0;
+
+    // agreement, outside the timed loops
+    memset(history, 0, sizeof(history));
+    history_index = 0;
+    event_rate_init(&er, window_ms, 0);
+    for (int i = 1; i < samples; i++) {
+        uint32_t now = (uint32_t)i * SAMPLE_MS;
+        if (event_at[i]) {
+            history[history_index] = now;
+            history_index = (history_index + 1) % HISTORY;
+            event_rate_add(&er, now);
+        }
+        uint32_t exact = scan_count(now, window_ms);
+        uint32_t edge = scan_count(now, window_ms + bucket_ms) - scan_count(now, window_ms - bucket_ms);
+        uint32_t got = event_rate_count(&er, now);
+        if (got + edge < exact || got > exact + edge) {
+            mismatches++;
+        }
+    }
+
+    printf("window %u ms, %d queries\n", window_ms, samples - 1);
+    printf("timestamp scan: %7.1f ns/query\n", scan_ns / (samples - 1));
+    printf("event_rate:     %7.1f ns/query (%.1fx)\n", ring_ns / (samples - 1), scan_ns / ring_ns);
+    printf("counts outside the edge bucket: %d\n", mismatches);
+    return mismatches != 0;
+}
@@ -0,0 +1,21 @@
+/*
+ * Host stand-in for the part of the Zephyr atomic API the firmware headers
+ * built into the tools use; sequentially consistent like Zephyr's.
+ */
+#ifndef HOST_ZEPHYR_SYS_ATOMIC_H
+#define HOST_ZEPHYR_SYS_ATOMIC_H
+
+typedef long atomic_t;
+typedef long atomic_val_t;
+
+static inline atomic_val_t atomic_get(const atomic_t *target)
+{
+    return __atomic_load_n(target, __ATOMIC_SEQ_CST);
+}
+
+static inline atomic_val_t atomic_set(atomic_t *target, atomic_val_t value)
+{
+    return __atomic_exchange_n(target, value, __ATOMIC_SEQ_CST);
+}
+
+#endif // HOST_ZEPHYR_SYS_ATOMIC_H
@@ -0,0 +1,13 @@
+/*
+ * Host stand-in for the Zephyr utility macros the firmware headers built
+ * into the tools use.
+ */
+#ifndef HOST_ZEPHYR_SYS_UTIL_H
+#define HOST_ZEPHYR_SYS_UTIL_H
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#define IS_POWER_OF_TWO(x) (((x) != 0U) && (((x) & ((x) - 1U)) == 0U))
+#define BUILD_ASSERT(expr, msg) _Static_assert(expr, msg)
+
+#endif // HOST_ZEPHYR_SYS_UTIL_H
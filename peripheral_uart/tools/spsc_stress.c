@@ -0,0 +1,151 @@
+/*
+ * Ordering check of spsc_ring under a concurrent producer and consumer.
+ *
+ * A producer thread writes sequence numbers into a small ring through
+ * write spans of varying length, committing element by element or a whole
+ * span at once, and now and then with spsc_ring_put(). The main thread
+ * drains it through read spans, checks every element and a peek past the
+ * span start, and consumes. Any element out of order, torn, or seen twice
+ * is an error.
+ *
+ * An element published before it is fully written is only caught if the
+ * consumer happens to read it in that window, which a plain build rarely
+ * does; a ThreadSanitizer build reports it as a data race on every run.
+ *
+ *   spsc_stress [-n elements] [-s seed]
+ *
+ * Build: cc -O2 -pthread -o spsc_stress spsc_stress.c -Ihost
+ *        cc -O1 -g -fsanitize=thread -pthread -o spsc_stress spsc_stress.c -Ihost
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../src/spsc_ring.h"
+
+#define RING_CAPACITY 64
+
+// three words, so a slot published before it is written shows as torn
+struct item {
+    uint32_t seq;
+    uint32_t check;
+    uint32_t inverse;
+};
+
+SPSC_RING_DEFINE(ring, struct item, RING_CAPACITY);
+
+static uint32_t elements = 2000000;
+static unsigned seed = 1;
+
+static void fill(struct item *it, uint32_t seq)
+{
+    it->seq = seq;
+    it->check = seq * 2654435761u;
+    it->inverse = ~seq;
+}
+
+static int torn(const struct item *it, uint32_t seq)
+{
+    return it->seq != seq || it->check != seq * 2654435761u || it->inverse != ~seq;
+}
+
+static void *producer(void *arg)
+{
+    (void)arg;
+    unsigned state = seed;
+    uint32_t seq = 0;
+
+    while (seq < elements) {
+        struct item *span;
+        uint32_t n = spsc_ring_write_span(&ring, (void **)&span);
+
+        if (n == 0) {
+            sched_yield();
+            continue;
+        }
+        int mode = rand_r(&state) % 4;
+        uint32_t burst = 1 + rand_r(&state) % 16;
+
+        n = MIN(MIN(n, burst), elements - seq);
+
+        if (mode == 0) {
+            struct item it;
+
+            fill(&it, seq++);
+            spsc_ring_put(&ring, &it);
+        } else if (mode == 1) {
+            for (uint32_t i = 0; i < n; i++) {
+                fill(&span[i], seq++);
+                spsc_ring_commit(&ring, 1);
+            }
+        } else {
+            for (uint32_t i = 0; i < n; i++) {
+                fill(&span[i], seq++);
+            }
+            spsc_ring_commit(&ring, n);
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+        if (opt == 'n') {
+            elements = strtoul(optarg, NULL, 0);
+        } else if (opt == 's') {
+            seed = atoi(optarg);
+        } else {
+            fprintf(stderr, "usage: %s [-n elements] [-s seed]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, producer, NULL) != 0) {
+        perror("pthread_create");
+        return 1;
+    }
+
+    uint32_t expect = 0;
+    uint32_t errors = 0;
+    uint32_t max_count = 0;
+    unsigned state = seed + 1;
+
+    while (expect < elements) {
+        struct item *span;
+        uint32_t n = spsc_ring_read_span(&ring, (void **)&span);
+
+        if (n == 0) {
+            sched_yield();
+            continue;
+        }
+        // peek anywhere in what is pending, which may extend past the span's wrap
+        uint32_t pending = spsc_ring_count(&ring);
+        max_count = MAX(max_count, pending);
+        uint32_t i = rand_r(&state) % pending;
+        if (torn(spsc_ring_peek(&ring, i), expect + i)) {
+            errors++;
+        }
+        // consume only part of the span now and then, so the tail moves unevenly
+        uint32_t burst = 1 + rand_r(&state) % 24;
+
+        n = MIN(n, burst);
+        for (i = 0; i < n; i++) {
+            if (torn(&span[i], expect + i)) {
+                errors++;
+            }
+        }
+        spsc_ring_consume(&ring, n);
+        expect += n;
+    }
+    pthread_join(thread, NULL);
+
+    printf("%u elements through a %u slot ring, backlog max %u, %u errors\n",
+           expect, RING_CAPACITY, max_count, errors);
+    return errors != 0;
+}
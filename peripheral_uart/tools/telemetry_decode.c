@@ -0,0 +1,185 @@
+/*
+ * Host side decoder for the binary telemetry frames sent by aggregator.c.
+ *
+ * Reads one notification per line from stdin as hex (spaces optional, as
+ * copied from nRF Connect), reassembles the fragments queued by ble_tx.c and
+ * prints the interval summary of every present field in physical units,
+ * preceded by the frame time and the timing of every running sample stream.
+ *
+ * Build: cc -O2 -o telemetry_decode telemetry_decode.c
+ */
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/ble_tx_frame.h"
+#include "../src/telemetry_schema.h"
+
+static const char *const field_name[TELEMETRY_FIELD_COUNT] = {
+#define TELEMETRY_NAME(name, scale, unit) #name,
+    TELEMETRY_FIELDS(TELEMETRY_NAME)
+#undef TELEMETRY_NAME
+};
+
+static const char *const field_unit[TELEMETRY_FIELD_COUNT] = {
+#define TELEMETRY_UNIT(name, scale, unit) unit,
+    TELEMETRY_FIELDS(TELEMETRY_UNIT)
+#undef TELEMETRY_UNIT
+};
+
+static const char *const stream_name[TELEMETRY_STREAM_COUNT] = { "PPG", "ADC", "IMU" };
+
+static uint16_t get_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return get_le16(p) | ((uint32_t)get_le16(p + 2) << 16);
+}
+
+static int parse_hex(const char *line, uint8_t *out, size_t max)
+{
+    size_t n = 0;
+    int nibble = -1;
+
+    for (; *line; line++) {
+        if (!isxdigit((unsigned char)*line)) {
+            continue;
+        }
+        int v = isdigit((unsigned char)*line) ? *line - '0' : (tolower((unsigned char)*line) - 'a' + 10);
+        if (nibble < 0) {
+            nibble = v;
+        } else {
+            if (n == max) {
+                return -1;
+            }
+            out[n++] = (uint8_t)((nibble << 4) | v);
+            nibble = -1;
+        }
+    }
+    return nibble < 0 ? (int)n : -1;
+}
+
+static void decode_frame(const uint8_t *frame, int len)
+{
+    if (len < TELEMETRY_HEADER_SIZE + TELEMETRY_CRC_SIZE) {
+        printf("short frame (%d bytes)\n", len);
+        return;
+    }
+
+    uint16_t crc = get_le16(frame + len - TELEMETRY_CRC_SIZE);
+    if (crc != telemetry_crc16(frame, len - TELEMETRY_CRC_SIZE)) {
+        printf("CRC mismatch\n");
+        return;
+    }
+    if (frame[0] != TELEMETRY_VERSION || frame[1] != TELEMETRY_SCHEMA_ID) {
+        printf("unsupported frame version %u schema %u\n", frame[0], frame[1]);
+        return;
+    }
+
+    uint16_t seq = get_le16(frame + 2);
+    uint32_t present = get_le16(frame + 4) | ((uint32_t)get_le16(frame + 6) << 16);
+    uint8_t flags = frame[8];
+    uint64_t time_us = get_le32(frame + 9) | ((uint64_t)get_le32(frame + 13) << 32);
+    const uint8_t *p = frame + TELEMETRY_HEADER_SIZE;
+    const uint8_t *end = frame + len - TELEMETRY_CRC_SIZE;
+
+    printf("seq %u at %.6f s\n", seq, time_us / 1e6);
+
+    if (p == end) {
+        printf("  truncated\n");
+        return;
+    }
+    uint8_t streams = *p++;
+    for (int stream = 0; stream < TELEMETRY_STREAM_COUNT; stream++) {
+        if (!(streams & (1U << stream))) {
+            continue;
+        }
+        if (p + TELEMETRY_TIMING_SIZE > end) {
+            printf("  truncated\n");
+            return;
+        }
+        // the block time is the low 32 bits of a time at or before the frame
+        uint64_t block_us = time_us - (uint32_t)((uint32_t)time_us - get_le32(p));
+        uint32_t rate_mhz = get_le32(p + 4);
+        p += TELEMETRY_TIMING_SIZE;
+
+        printf("  %-14s last block %.6f s, %u.%03u Hz\n", stream_name[stream],
+               block_us / 1e6, rate_mhz / 1000, rate_mhz % 1000);
+    }
+
+    printf("  %-14s %5s %10s %10s %10s %10s\n", "field", "n", "mean", "min", "max",
+           (flags & TELEMETRY_FLAG_STDDEV) ? "stddev" : "");
+    for (int field = 0; field < TELEMETRY_FIELD_COUNT; field++) {
+        if (!(present & (1UL << field))) {
+            continue;
+        }
+        if (p + TELEMETRY_SUMMARY_SIZE(flags) > end) {
+            printf("  truncated\n");
+            return;
+        }
+        double scale = telemetry_field_scale[field];
+        uint8_t count = p[0];
+        int16_t mean = (int16_t)get_le16(p + 1);
+        int16_t min = (int16_t)get_le16(p + 3);
+        int16_t max = (int16_t)get_le16(p + 5);
+        p += 7;
+
+        printf("  %-14s %5u %10.2f %10.2f %10.2f", field_name[field], count,
+               mean / scale, min / scale, max / scale);
+        if (flags & TELEMETRY_FLAG_STDDEV) {
+            printf(" %10.2f", get_le16(p) / scale / (1 << TELEMETRY_STDDEV_FRAC_BITS));
+            p += 2;
+        }
+        printf(" %s\n", field_unit[field]);
+    }
+}
+
+int main(void)
+{
+    char line[1024];
+    uint8_t notification[1 + TELEMETRY_MAX_FRAME_SIZE];
+    uint8_t frame[TELEMETRY_MAX_FRAME_SIZE];
+    int frame_len = -1;     // -1 while waiting for a start fragment
+    int frame_id = 0;
+
+    while (fgets(line, sizeof(line), stdin)) {
+        int len = parse_hex(line, notification, sizeof(notification));
+        if (len < 0) {
+            printf("bad hex input\n");
+            continue;
+        }
+        if (len == 0) {
+            continue;
+        }
+
+        uint8_t hdr = notification[0];
+        if (hdr & BLE_TX_HDR_START) {
+            if (frame_len >= 0) {
+                printf("incomplete frame dropped\n");
+            }
+            frame_len = 0;
+            frame_id = hdr & BLE_TX_HDR_ID_MASK;
+        } else if (frame_len < 0 || (hdr & BLE_TX_HDR_ID_MASK) != frame_id) {
+            printf("stray fragment\n");
+            frame_len = -1;
+            continue;
+        }
+        if (frame_len + len - BLE_TX_HDR_SIZE > (int)sizeof(frame)) {
+            printf("frame too long\n");
+            frame_len = -1;
+            continue;
+        }
+        memcpy(frame + frame_len, notification + BLE_TX_HDR_SIZE,
+               len - BLE_TX_HDR_SIZE);
+        frame_len += len - BLE_TX_HDR_SIZE;
+
+        if (hdr & BLE_TX_HDR_END) {
+            decode_frame(frame, frame_len);
+            frame_len = -1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * Compression ratio and speed of wave_codec on recorded waveforms.
+ *
+ * Input is CSV on stdin, one sample per line and one integer column per
+ * channel, as written by `waveform_decode <stream>`. The data is coded in
+ * blocks the way waveform.c does and every block is decoded again to check
+ * it round-trips.
+ *
+ *   wave_codec_bench [-n samples_per_block] [-b raw_bytes_per_value] < ppg.csv
+ *
+ * On-device cycles per sample are reported by waveform_print_stats().
+ *
+ * Build: cc -O2 -o wave_codec_bench wave_codec_bench.c ../src/wave_codec.c
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../src/wave_codec.h"
+
+#define MAX_CHANNELS 16
+#define MAX_BLOCK    255
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+    int block_samples = 128;
+    int value_size = 3;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:b:")) != -1) {
+        if (opt == 'n') {
+            block_samples = atoi(optarg);
+        } else if (opt == 'b') {
+            value_size = atoi(optarg);
+        } else {
+            fprintf(stderr, "usage: %s [-n samples_per_block] [-b raw_bytes_per_value] < data.csv\n", argv[0]);
+            return 1;
+        }
+    }
+    if (block_samples < 1 || block_samples > MAX_BLOCK) {
+        fprintf(stderr, "block size must be 1..%d\n", MAX_BLOCK);
+        return 1;
+    }
+
+    // read the whole recording
+    size_t cap = 4096, n = 0;
+    int channels = 0;
+    int32_t *data = malloc(cap * MAX_CHANNELS * sizeof(int32_t));
+    char line[1024];
+
+    while (fgets(line, sizeof(line), stdin)) {
+        int ch = 0;
+        char *p = line, *end;
+        if (n == cap) {
+            cap *= 2;
+            data = realloc(data, cap * MAX_CHANNELS * sizeof(int32_t));
+        }
+        while (ch < MAX_CHANNELS) {
+            long v = strtol(p, &end, 10);
+            if (end == p) {
+                break;
+            }
+            data[n * MAX_CHANNELS + ch++] = (int32_t)v;
+            p = end + strspn(end, ", \t");
+        }
+        if (ch == 0) {
+            continue;
+        }
+        if (channels == 0) {
+            channels = ch;
+        } else if (ch != channels) {
+            fprintf(stderr, "line %zu: %d columns, expected %d\n", n + 1, ch, channels);
+            return 1;
+        }
+        n++;
+    }
+    if (n == 0) {
+        fprintf(stderr, "no samples\n");
+        return 1;
+    }
+
+    int32_t block[MAX_BLOCK * MAX_CHANNELS], decoded[MAX_BLOCK * MAX_CHANNELS];
+    uint8_t coded[MAX_BLOCK * MAX_CHANNELS * 6 + MAX_CHANNELS * 8];
+    size_t raw_bytes = 0, coded_bytes = 0;
+    double enc_ns = 0, dec_ns = 0;
+
+    for (size_t start = 0; start < n; start += block_samples) {
+        int count = (int)(n - start < (size_t)block_samples ? n - start : (size_t)block_samples);
+        for (int i = 0; i < count; i++) {
+            memcpy(&block[i * channels], &data[(start + i) * MAX_CHANNELS], channels * sizeof(int32_t));
+        }
+
+        double t0 = now_ns();
+        int len = wave_codec_encode(block, count, channels, coded, sizeof(coded));
+        double t1 = now_ns();
+        int used = wave_codec_decode(coded, len, count, channels, decoded);
+        double t2 = now_ns();
+
+        if (len < 0 || used != len || memcmp(block, decoded, count * channels * sizeof(int32_t))) {
+            fprintf(stderr, "round trip failed at sample %zu\n", start);
+            return 1;
+        }
+        raw_bytes += (size_t)count * channels * value_size;
+        coded_bytes += len;
+        enc_ns += t1 - t0;
+        dec_ns += t2 - t1;
+    }
+
+    printf("%zu samples x %d channels, %d samples per block\n", n, channels, block_samples);
+    printf("raw %zu bytes, coded %zu bytes, ratio %.2f (%.2f bits/value)\n",
+           raw_bytes, coded_bytes, (double)raw_bytes / coded_bytes,
+           8.0 * coded_bytes / ((double)n * channels));
+    printf("encode %.1f ns/sample, decode %.1f ns/sample (host)\n", enc_ns / n, dec_ns / n);
+    free(data);
+    return 0;
+}
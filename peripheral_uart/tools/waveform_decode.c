@@ -0,0 +1,160 @@
+/*
+ * Host side decoder for the waveform service notifications (waveform.c).
+ *
+ * Reads one notification per line from stdin as hex, reassembles fragments,
+ * decodes raw and compressed blocks and writes CSV:
+ *   waveform_decode          stream,sequence,time_us,index,value...
+ *   waveform_decode <id>     value... of stream <id> only, e.g. to record
+ *                            data for wave_codec_bench
+ * time_us is the time of each sample on the common time base of all streams,
+ * from the block start timestamp and the stream's effective sample period.
+ * The 32 bit block start is unwrapped against the stream's previous block,
+ * so the times stay monotonic past 71.6 minutes as long as no stream pauses
+ * for half of that.
+ *
+ * Build: cc -O2 -o waveform_decode waveform_decode.c ../src/wave_codec.c
+ */
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/ble_tx_frame.h"
+#include "../src/wave_codec.h"
+#include "../src/waveform.h"
+
+static int only_stream = -1;
+
+// unwrapped start of the previous block of every stream id, 0 before the first
+static uint64_t last_start_us[256];
+
+static int parse_hex(const char *line, uint8_t *out, size_t max)
+{
+    size_t n = 0;
+    int nibble = -1;
+
+    for (; *line; line++) {
+        if (!isxdigit((unsigned char)*line)) {
+            continue;
+        }
+        int v = isdigit((unsigned char)*line) ? *line - '0' : (tolower((unsigned char)*line) - 'a' + 10);
+        if (nibble < 0) {
+            nibble = v;
+        } else {
+            if (n == max) {
+                return -1;
+            }
+            out[n++] = (uint8_t)((nibble << 4) | v);
+            nibble = -1;
+        }
+    }
+    return nibble < 0 ? (int)n : -1;
+}
+
+static void decode_block(const uint8_t *block, int len)
+{
+    int32_t values[255 * WAVEFORM_MAX_CHANNELS];
+
+    if (len < WAVEFORM_HEADER_SIZE) {
+        fprintf(stderr, "short block\n");
+        return;
+    }
+
+    int stream = block[0];
+    int channels = block[1] >> 4;
+    int value_size = block[1] & 0x07;
+    int count = block[2];
+    int sequence = block[3];
+    uint32_t start = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32_t)block[7] << 24);
+    uint32_t period_ns = block[8] | (block[9] << 8) | (block[10] << 16) | ((uint32_t)block[11] << 24);
+    const uint8_t *payload = block + WAVEFORM_HEADER_SIZE;
+    int payload_len = len - WAVEFORM_HEADER_SIZE;
+
+    if (channels == 0 || channels > WAVEFORM_MAX_CHANNELS || value_size == 0 || value_size > 4) {
+        fprintf(stderr, "bad block format 0x%02x\n", block[1]);
+        return;
+    }
+
+    if (block[1] & WAVEFORM_FORMAT_COMPRESSED) {
+        if (wave_codec_decode(payload, payload_len, count, channels, values) < 0) {
+            fprintf(stderr, "corrupt compressed block\n");
+            return;
+        }
+    } else {
+        if (payload_len < count * channels * value_size) {
+            fprintf(stderr, "short raw block\n");
+            return;
+        }
+        for (int n = 0; n < count * channels; n++) {
+            uint32_t v = 0;
+            for (int i = 0; i < value_size; i++) {
+                v |= (uint32_t)payload[n * value_size + i] << (8 * i);
+            }
+            // sign extend
+            int shift = 32 - 8 * value_size;
+            values[n] = (int32_t)(v << shift) >> shift;
+        }
+    }
+
+    uint64_t start_us = start;
+    if (last_start_us[stream] != 0) {
+        start_us = last_start_us[stream] + (int32_t)(start - (uint32_t)last_start_us[stream]);
+    }
+    last_start_us[stream] = start_us;
+
+    if (only_stream >= 0 && stream != only_stream) {
+        return;
+    }
+    for (int n = 0; n < count; n++) {
+        if (only_stream < 0) {
+            uint64_t time_us = start_us + (uint64_t)n * period_ns / 1000;
+            printf("%d,%d,%llu,%d", stream, sequence, (unsigned long long)time_us, n);
+        }
+        for (int ch = 0; ch < channels; ch++) {
+            printf(only_stream < 0 || ch > 0 ? ",%d" : "%d", values[n * channels + ch]);
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    char line[1024];
+    uint8_t notification[512];
+    uint8_t block[512];
+    int block_len = -1;
+    int block_id = 0;
+
+    if (argc > 1) {
+        only_stream = atoi(argv[1]);
+    }
+
+    while (fgets(line, sizeof(line), stdin)) {
+        int len = parse_hex(line, notification, sizeof(notification));
+        if (len <= 0) {
+            continue;
+        }
+
+        uint8_t hdr = notification[0];
+        if (hdr & BLE_TX_HDR_START) {
+            block_len = 0;
+            block_id = hdr & BLE_TX_HDR_ID_MASK;
+        } else if (block_len < 0 || (hdr & BLE_TX_HDR_ID_MASK) != block_id) {
+            block_len = -1;
+            continue;
+        }
+        if (block_len + len - BLE_TX_HDR_SIZE > (int)sizeof(block)) {
+            block_len = -1;
+            continue;
+        }
+        memcpy(block + block_len, notification + BLE_TX_HDR_SIZE,
+               len - BLE_TX_HDR_SIZE);
+        block_len += len - BLE_TX_HDR_SIZE;
+
+        if (hdr & BLE_TX_HDR_END) {
+            decode_block(block, block_len);
+            block_len = -1;
+        }
+    }
+    return 0;
+}